@@ -1,4 +1,4 @@
-QT       += core gui svg sql
+QT       += core gui svg sql concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -23,14 +23,23 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    core/autosavemanager.cpp \
+    core/blobstore.cpp \
     core/databasemanager.cpp \
+    core/exportmanager.cpp \
     core/filemanager.cpp \
+    core/historymanager.cpp \
+    core/imageingestor.cpp \
+    core/moviecache.cpp \
     core/projectmanager.cpp \
     core/settingmanager.cpp \
+    core/thumbnailcache.cpp \
     gui/codeeditor/codeeditor.cpp \
+    gui/codeeditor/codeeditorpool.cpp \
     gui/codeeditor/cpplanguagespec.cpp \
     gui/codeeditor/javalanguagespec.cpp \
     gui/codeeditor/javascriptlanguagespec.cpp \
+    gui/codeeditor/languageregistry.cpp \
     gui/codeeditor/languagespecfactory.cpp \
     gui/codeeditor/pythonlanguagespec.cpp \
     gui/codeeditor/rustlanguagespec.cpp \
@@ -50,6 +59,7 @@ SOURCES += \
     gui/noteeditor/itemcell.cpp \
     gui/noteeditor/markdownitemcell.cpp \
     gui/noteeditor/noteeditor.cpp \
+    gui/noteeditor/slicedmarkdownhighlighter.cpp \
     gui/noteeditor/textitemcell.cpp \
     gui/popover/popoverwidget.cpp \
     gui/popover/tagspopover.cpp \
@@ -68,9 +78,13 @@ SOURCES += \
     gui/tabs/notetab.cpp \
     gui/tabs/tagonlynotetab.cpp \
     gui/widgets/fontcombobox.cpp \
+    gui/widgets/historydialog.cpp \
     gui/widgets/logviewer.cpp \
     gui/widgets/menubar.cpp \
     gui/widgets/menutoolbutton.cpp \
+    gui/widgets/recentprojectdelegate.cpp \
+    gui/widgets/recentprojectmodel.cpp \
+    gui/widgets/repotreemodel.cpp \
     gui/widgets/searchbox.cpp \
     gui/widgets/tabwidget.cpp \
     gui/widgets/tagswidget.cpp \
@@ -80,18 +94,29 @@ SOURCES += \
     util/fontmanager.cpp \
     util/logmanager.cpp \
     util/metactk.cpp \
+    util/notejournal.cpp \
+    util/savequeue.cpp \
     util/sqldatabase.cpp \
     util/stylemanager.cpp
 
 HEADERS += \
+    core/autosavemanager.h \
+    core/blobstore.h \
     core/databasemanager.h \
+    core/exportmanager.h \
     core/filemanager.h \
+    core/historymanager.h \
+    core/imageingestor.h \
+    core/moviecache.h \
     core/projectmanager.h \
     core/settingmanager.h \
+    core/thumbnailcache.h \
     gui/codeeditor/codeeditor.h \
+    gui/codeeditor/codeeditorpool.h \
     gui/codeeditor/cpplanguagespec.h \
     gui/codeeditor/javalanguagespec.h \
     gui/codeeditor/javascriptlanguagespec.h \
+    gui/codeeditor/languageregistry.h \
     gui/codeeditor/languagespec.h \
     gui/codeeditor/languagespecfactory.h \
     gui/codeeditor/pythonlanguagespec.h \
@@ -112,6 +137,7 @@ HEADERS += \
     gui/noteeditor/itemcell.h \
     gui/noteeditor/markdownitemcell.h \
     gui/noteeditor/noteeditor.h \
+    gui/noteeditor/slicedmarkdownhighlighter.h \
     gui/noteeditor/textitemcell.h \
     gui/popover/popoverwidget.h \
     gui/popover/tagspopover.h \
@@ -130,9 +156,13 @@ HEADERS += \
     gui/tabs/notetab.h \
     gui/tabs/tagonlynotetab.h \
     gui/widgets/fontcombobox.h \
+    gui/widgets/historydialog.h \
     gui/widgets/logviewer.h \
     gui/widgets/menubar.h \
     gui/widgets/menutoolbutton.h \
+    gui/widgets/recentprojectdelegate.h \
+    gui/widgets/recentprojectmodel.h \
+    gui/widgets/repotreemodel.h \
     gui/widgets/searchbox.h \
     gui/widgets/tabwidget.h \
     gui/widgets/tagswidget.h \
@@ -145,6 +175,8 @@ HEADERS += \
     util/fontmanager.h \
     util/logmanager.h \
     util/metactk.h \
+    util/notejournal.h \
+    util/savequeue.h \
     util/sqldatabase.h \
     util/stylemanager.h
 
@@ -0,0 +1,181 @@
+#include "autosavemanager.h"
+#include "metactk.h"
+#include "notejournal.h"
+#include "savequeue.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+AutoSaveManager::AutoSaveManager(QObject *parent) : QObject(parent)
+{
+    QObject::connect(SaveQueue::getSaveQueue(), &SaveQueue::saveFinished,
+                     this, &AutoSaveManager::onSaveFinished);
+}
+
+void AutoSaveManager::init(const QString &indexPath)
+{
+    m_indexPath = indexPath;
+    QDir().mkpath(QFileInfo(indexPath).absolutePath());
+    loadIndex();
+}
+
+void AutoSaveManager::setAutoSave(bool enabled)
+{
+    if(m_autoSave == enabled) return;
+    m_autoSave = enabled;
+    emit autoSaveChanged(enabled);
+}
+
+// 在日志写入前记入索引，异常退出后启动时才能找到它
+void AutoSaveManager::registerJournal(const QString &configPath)
+{
+    if(configPath.isEmpty() || m_journals.contains(configPath)) return;
+    m_journals.insert(configPath);
+    saveIndex();
+}
+
+void AutoSaveManager::unregisterJournal(const QString &configPath)
+{
+    if(m_journals.remove(configPath)) saveIndex();
+}
+
+// 日志中offset之前的记录已包含在正在保存的快照中
+void AutoSaveManager::compactStarted(const QString &configPath, qint64 journalOffset, quint64 ticket)
+{
+    if(journalOffset <= 0) return;
+    m_compactOffsets[configPath] = PendingCompact{journalOffset, ticket};
+}
+
+// 放弃未保存的编辑
+void AutoSaveManager::discardJournal(const QString &configPath)
+{
+    m_compactOffsets.remove(configPath);
+    NoteJournal(configPath).remove();
+    unregisterJournal(configPath);
+}
+
+// 只按最近一次压缩对应的保存结果处理，更早的保存结果由它取代
+void AutoSaveManager::onSaveFinished(const QString &configPath, bool success, quint64 ticket)
+{
+    auto it = m_compactOffsets.constFind(configPath);
+    if(it == m_compactOffsets.constEnd() || it->ticket != ticket) return;
+    qint64 offset = it->offset;
+    m_compactOffsets.remove(configPath);
+    // 写入失败时日志保持完整
+    if(!success) return;
+
+    NoteJournal journal(configPath);
+    journal.discardPrefix(offset);
+    if(!journal.exists()) unregisterJournal(configPath);
+}
+
+// 将遗留的编辑日志重放到对应的meta.ctk并保存，返回恢复的笔记数
+int AutoSaveManager::recoverJournals(const QString &rootPath)
+{
+    bool changed = false;
+    if(m_indexMissing)
+    {
+        // 旧版本没有索引，遍历一次仓库重建
+        QDirIterator it(rootPath, QStringList() << "meta.ctk.journal", QDir::Files, QDirIterator::Subdirectories);
+        while(it.hasNext())
+        {
+            QString journalPath = it.next();
+            m_journals.insert(journalPath.left(journalPath.size() - QString(".journal").size()));
+        }
+        m_indexMissing = false;
+        changed = true;
+    }
+
+    int recovered = 0;
+    const QSet<QString> journals = m_journals;
+    for(const QString &configPath : journals)
+    {
+        bool noteRecovered = false;
+        // 恢复失败的日志保留在索引中，下次启动再试
+        if(!recoverJournal(configPath, noteRecovered)) continue;
+        m_journals.remove(configPath);
+        changed = true;
+        if(noteRecovered) recovered++;
+    }
+    if(changed) saveIndex();
+    if(recovered > 0) qInfo() << "Recovered" << recovered << "notes from edit journals";
+    return recovered;
+}
+
+// 返回true表示日志已处理完（恢复并删除，或本就不存在）
+bool AutoSaveManager::recoverJournal(const QString &configPath, bool &recovered)
+{
+    recovered = false;
+    NoteJournal journal(configPath);
+    if(!journal.exists()) return true;
+
+    // 正文读取失败时不能在它上面重放，也不能删除日志
+    MetaCtk metaCtk(configPath);
+    if(!metaCtk.load() || metaCtk.noteContentLoadFailed())
+    {
+        qWarning() << "Failed to recover the journal" << journal.journalPath();
+        return false;
+    }
+    CodeNote codeNote = metaCtk.noteContent();
+    if(journal.replay(codeNote) > 0)
+    {
+        metaCtk.setNoteContent(codeNote);
+        if(!metaCtk.save())
+        {
+            qWarning() << "Failed to save the recovered note" << configPath;
+            return false;
+        }
+        // 重新读取，确认写入的内容完整后才删除日志
+        MetaCtk saved(configPath);
+        if(!saved.load() || saved.noteContentLoadFailed()
+                || saved.noteContent().note != codeNote.note || saved.noteContent().tags != codeNote.tags)
+        {
+            qWarning() << "Failed to verify the recovered note" << configPath;
+            return false;
+        }
+        recovered = true;
+    }
+    journal.remove();
+    return true;
+}
+
+// 索引文件不存在或无法解析时，恢复前遍历仓库重建
+void AutoSaveManager::loadIndex()
+{
+    m_journals.clear();
+    QFile file(m_indexPath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        m_indexMissing = true;
+        return;
+    }
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if(error.error != QJsonParseError::NoError || !doc.isArray())
+    {
+        qWarning() << "Invalid journal index, rebuilding" << m_indexPath;
+        m_indexMissing = true;
+        return;
+    }
+    for(const QJsonValue &value : doc.array())
+    {
+        if(!value.toString().isEmpty()) m_journals.insert(value.toString());
+    }
+}
+
+void AutoSaveManager::saveIndex() const
+{
+    if(m_indexPath.isEmpty()) return;
+    QStringList paths = m_journals.values();
+    paths.sort();
+    QByteArray data = QJsonDocument(QJsonArray::fromStringList(paths)).toJson(QJsonDocument::Compact);
+    if(!SaveQueue::writeAtomically(m_indexPath, data, SaveQueue::getSaveQueue()->syncPolicy()))
+    {
+        qWarning() << "Failed to write the journal index" << m_indexPath;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef AUTOSAVEMANAGER_H
+#define AUTOSAVEMANAGER_H
+/*****************************************************
+*
+* @file     autosavemanager.h
+* @brief    自动保存管理类（单例）
+*
+* @description
+*           ==== 核心功能 ====
+*           - 保存自动保存相关设置（autoSave、saveOnClose、日志间隔、压缩间隔与阈值）
+*           - 保存完成后丢弃已写入meta.ctk的编辑日志前缀
+*           - 维护现存编辑日志的索引（data/journals.json），启动时只检查索引中的日志，不遍历仓库
+*           - 启动时将异常退出遗留的编辑日志重放到meta.ctk，保存并校验成功后才删除日志
+*           ==== 使用说明 ====
+*           1. 启动时先init(索引路径)，再调用recoverJournals()
+*           2. NoteTab追加日志前调用registerJournal()，保证日志写入前已记入索引
+*           3. NoteTab编辑后按journalInterval()防抖追加日志，
+*              超过compactInterval()或日志超过compactThreshold()时保存（压缩）
+*           4. 保存开始时调用compactStarted()记录日志偏移
+*           ==== 注意 ====
+*           1. 索引文件不存在时（旧版本升级）遍历一次仓库重建索引
+*           2. 索引中日志已不存在的条目在恢复时清除
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+class AutoSaveManager : public QObject
+{
+    Q_OBJECT
+public:
+    // 单例模式
+    static AutoSaveManager *getAutoSaveManager()
+    {
+        static AutoSaveManager a;
+        return &a;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    AutoSaveManager(const AutoSaveManager&) = delete;
+    AutoSaveManager& operator=(const AutoSaveManager&) = delete;
+
+    // ======== 设置 ========
+    bool autoSave() const { return m_autoSave; }
+    void setAutoSave(bool enabled);
+    bool saveOnClose() const { return m_saveOnClose; }
+    void setSaveOnClose(bool enabled) { m_saveOnClose = enabled; }
+    int journalInterval() const { return m_journalInterval; }
+    void setJournalInterval(int msec) { m_journalInterval = msec; }
+    int compactInterval() const { return m_compactInterval; }
+    void setCompactInterval(int msec) { m_compactInterval = msec; }
+    qint64 compactThreshold() const { return m_compactThreshold; }
+    void setCompactThreshold(qint64 bytes) { m_compactThreshold = bytes; }
+
+    // ======== 日志管理 ========
+    void init(const QString& indexPath);
+    void registerJournal(const QString& configPath);
+    void compactStarted(const QString& configPath, qint64 journalOffset, quint64 ticket);
+    void discardJournal(const QString& configPath);
+    int recoverJournals(const QString& rootPath);
+
+signals:
+    void autoSaveChanged(bool enabled);
+
+private:
+    explicit AutoSaveManager(QObject *parent = nullptr);
+
+    void onSaveFinished(const QString& configPath, bool success, quint64 ticket);
+    void unregisterJournal(const QString& configPath);
+    bool recoverJournal(const QString& configPath, bool &recovered);
+    void loadIndex();
+    void saveIndex() const;
+
+    bool m_autoSave = false;
+    bool m_saveOnClose = true;
+    int m_journalInterval = 1000;               // 编辑后追加日志的防抖间隔
+    int m_compactInterval = 30 * 1000;          // 首次编辑后多久压缩到meta.ctk
+    qint64 m_compactThreshold = 256 * 1024;     // 日志超过该大小立即压缩
+    // 等待中的压缩：保存完成后可丢弃的日志偏移及对应的保存编号
+    struct PendingCompact {
+        qint64 offset = 0;
+        quint64 ticket = 0;
+    };
+    QHash<QString, PendingCompact> m_compactOffsets; // meta.ctk路径 -> 最近一次压缩
+    QString m_indexPath;
+    QSet<QString> m_journals;                   // 可能存在编辑日志的meta.ctk路径
+    bool m_indexMissing = false;
+};
+
+#endif // AUTOSAVEMANAGER_H
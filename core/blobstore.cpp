@@ -0,0 +1,277 @@
+#include "blobstore.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+BlobStore::BlobStore(QObject *parent) : QObject(parent)
+{
+    m_gcTimer.setInterval(10 * 60 * 1000); // 默认十分钟回收一次
+    QObject::connect(&m_gcTimer, &QTimer::timeout, this, &BlobStore::collectGarbage);
+}
+
+void BlobStore::init(const QString &blobDir)
+{
+    m_blobDir = QDir(blobDir).absolutePath();
+    if(!QDir().mkpath(m_blobDir))
+    {
+        qWarning() << "Failed to create the blob directory" << m_blobDir;
+        return;
+    }
+    // 旧版本的引用计数文件，存活状态已改为由已保存的数据决定
+    QFile::remove(m_blobDir + "/refs.json");
+    m_gcTimer.start();
+    qInfo() << "BlobStore initialized" << m_blobDir;
+}
+
+QString BlobStore::blobDir() const
+{
+    return m_blobDir;
+}
+
+// 将文件存入存储，相同内容直接复用
+QString BlobStore::ingestFile(const QString &sourcePath, IngestFlags flags)
+{
+    if(m_blobDir.isEmpty())
+    {
+        qWarning() << "BlobStore is not initialized";
+        return "";
+    }
+    QFileInfo srcInfo(sourcePath);
+    if(!srcInfo.isFile())
+    {
+        qWarning() << "The sourcePath is an invalid file" << sourcePath;
+        return "";
+    }
+    // 已在存储中的文件直接复用
+    if(isBlobPath(sourcePath))
+    {
+        pin(sourcePath);
+        return QDir::cleanPath(srcInfo.absoluteFilePath());
+    }
+
+    QString hash = hashFile(sourcePath);
+    if(hash.isEmpty()) return "";
+
+    QString blobPath = blobPathFor(hash, srcInfo.suffix());
+    // 先固定，防止后台回收与入库竞争
+    pin(blobPath);
+    if(QFile::exists(blobPath)) return blobPath;
+
+    if(!QDir().mkpath(QFileInfo(blobPath).path()) || !linkOrCopy(sourcePath, blobPath, flags))
+    {
+        qWarning() << "Failed to store the blob" << sourcePath;
+        return "";
+    }
+    return blobPath;
+}
+
+// 将内存中的图片编码后存入存储
+QString BlobStore::ingestImage(const QImage &image, const char *format, int quality)
+{
+    if(m_blobDir.isEmpty() || image.isNull()) return "";
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if(!image.save(&buffer, format, quality))
+    {
+        qWarning() << "Failed to encode the image";
+        return "";
+    }
+
+    QString hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+    QString blobPath = blobPathFor(hash, QString(format).toLower());
+    pin(blobPath);
+    if(QFile::exists(blobPath)) return blobPath;
+
+    QDir().mkpath(QFileInfo(blobPath).path());
+    QSaveFile file(blobPath);
+    if(!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+    {
+        qWarning() << "Failed to write the blob" << blobPath << file.errorString();
+        return "";
+    }
+    return blobPath;
+}
+
+// 从内存缓冲区入库：哈希和写入都直接使用调用方的缓冲区
+QString BlobStore::ingestData(const char *data, qint64 size, const QString &suffix)
+{
+    if(m_blobDir.isEmpty() || !data || size < 0) return "";
+
+    QCryptographicHash hasher(QCryptographicHash::Sha1);
+    const qint64 chunkSize = 64 * 1024 * 1024; // addData一次最多接受int长度
+    for(qint64 offset = 0; offset < size; offset += chunkSize)
+    {
+        hasher.addData(data + offset, static_cast<int>(qMin(size - offset, chunkSize)));
+    }
+    QString blobPath = blobPathFor(hasher.result().toHex(), suffix);
+    pin(blobPath);
+    if(QFile::exists(blobPath)) return blobPath;
+
+    QDir().mkpath(QFileInfo(blobPath).path());
+    QSaveFile file(blobPath);
+    if(!file.open(QIODevice::WriteOnly) || file.write(data, size) != size || !file.commit())
+    {
+        qWarning() << "Failed to write the blob" << blobPath << file.errorString();
+        return "";
+    }
+    return blobPath;
+}
+
+bool BlobStore::isBlobPath(const QString &path) const
+{
+    if(m_blobDir.isEmpty() || path.isEmpty()) return false;
+    QString cleanPath = QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+    return cleanPath.startsWith(m_blobDir + "/", Qt::CaseInsensitive);
+}
+
+// 可能在工作线程调用
+void BlobStore::pin(const QString &blobPath)
+{
+    if(!isBlobPath(blobPath)) return;
+    QMutexLocker locker(&m_mutex);
+    m_pinned.insert(blobKey(blobPath));
+}
+
+void BlobStore::addReferenceScanner(ReferenceScanner scanner)
+{
+    m_scanners.append(std::move(scanner));
+}
+
+// 后台标记-清除：只有超过宽限期、本次运行未入库、且不被任何已保存数据引用的文件才删除
+void BlobStore::collectGarbage()
+{
+    if(m_blobDir.isEmpty() || m_gcRunning) return;
+    m_gcRunning = true;
+
+    const QString blobDir = m_blobDir;
+    const QDateTime deadline = QDateTime::currentDateTime().addSecs(-m_gcGracePeriod);
+    const QVector<ReferenceScanner> scanners = m_scanners;
+
+    QtConcurrent::run([=](){
+        // ==== 候选：超过宽限期且未固定 ====
+        QStringList candidates;
+        QDirIterator it(blobDir, QDir::Files, QDirIterator::Subdirectories);
+        while(it.hasNext())
+        {
+            QString path = it.next();
+            QFileInfo info = it.fileInfo();
+            // 只处理分片目录中的文件
+            if(info.dir().dirName().size() != 2) continue;
+            if(info.lastModified() > deadline) continue;
+
+            QMutexLocker locker(&m_mutex);
+            if(!m_pinned.contains(info.fileName())) candidates.append(path);
+        }
+
+        // ==== 标记：没有候选时不扫描 ====
+        QSet<QString> referenced;
+        bool marked = true;
+        if(!candidates.isEmpty())
+        {
+            QSet<QString> paths;
+            for(const ReferenceScanner &scanner : scanners)
+            {
+                if(!scanner(paths))
+                {
+                    qWarning() << "BlobStore skipped garbage collection, failed to scan references";
+                    marked = false;
+                    break;
+                }
+            }
+            for(const QString &path : paths)
+            {
+                if(isBlobPath(path)) referenced.insert(blobKey(path));
+            }
+        }
+
+        // ==== 清除 ====
+        int removed = 0;
+        for(int i = 0; marked && i < candidates.size(); i++)
+        {
+            QString key = QFileInfo(candidates[i]).fileName();
+            if(referenced.contains(key)) continue;
+            // 扫描期间可能被重新入库
+            QMutexLocker locker(&m_mutex);
+            if(m_pinned.contains(key)) continue;
+            if(QFile::remove(candidates[i])) removed++;
+        }
+        QMetaObject::invokeMethod(this, [=](){
+            m_gcRunning = false;
+            if(removed > 0) qInfo() << "BlobStore garbage collected" << removed << "blobs";
+            emit garbageCollected(removed);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void BlobStore::setGcInterval(int msec)
+{
+    m_gcTimer.setInterval(msec);
+}
+
+QString BlobStore::hashFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Failed to open the file" << filePath;
+        return "";
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if(!hash.addData(&file)) return "";
+    return hash.result().toHex();
+}
+
+QString BlobStore::blobPathFor(const QString &hash, const QString &suffix) const
+{
+    QString fileName = suffix.isEmpty() ? hash : hash + "." + suffix.toLower();
+    return m_blobDir + "/" + hash.left(2) + "/" + fileName;
+}
+
+QString BlobStore::blobKey(const QString &blobPath) const
+{
+    return QFileInfo(blobPath).fileName();
+}
+
+// 硬链接失败（跨卷、文件系统不支持）时回退为复制
+bool BlobStore::linkOrCopy(const QString &sourcePath, const QString &destPath, IngestFlags flags)
+{
+    if(flags.testFlag(AllowLink))
+    {
+#ifdef Q_OS_WIN
+        if(CreateHardLinkW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(destPath).utf16()),
+                           reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(sourcePath).utf16()),
+                           nullptr))
+            return true;
+#else
+        if(::link(QFile::encodeName(sourcePath).constData(), QFile::encodeName(destPath).constData()) == 0)
+            return true;
+#endif
+    }
+
+    // 先复制到临时文件再重命名，避免中途失败留下残缺文件
+    QString tempPath = destPath + ".tmp";
+    QFile::remove(tempPath);
+    if(!QFile::copy(sourcePath, tempPath)) return false;
+    if(!QFile::rename(tempPath, destPath))
+    {
+        QFile::remove(tempPath);
+        return QFile::exists(destPath); // 并发入库时可能已存在
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef BLOBSTORE_H
+#define BLOBSTORE_H
+/*****************************************************
+*
+* @file     blobstore.h
+* @brief    内容寻址的图片（及大内容文件）存储类（单例）
+*
+* @description
+*           ==== 核心功能 ====
+*           - 以内容哈希(SHA-1)为键存储图片，相同内容只保存一份
+*           - 分片目录：<blobDir>/<哈希前两位>/<哈希>.<后缀>
+*           - 入库时优先硬链接（仅限AllowLink），失败则复制
+*           - 后台定时标记-清除回收：先找出超过宽限期且本次运行未入库的文件，
+*             再由引用扫描器从已保存的数据（meta.ctk、编辑日志、历史版本）收集仍被引用的路径，
+*             只删除未被引用的文件
+*           ==== 使用说明 ====
+*           1. 启动时调用init()设置存储目录，addReferenceScanner()注册引用来源
+*           2. ingestFile()/ingestImage()返回稳定的图片路径
+*              ingestImage()可在工作线程调用，编码参数由ImageIngestor按设置传入
+*              ingestData()直接从内存缓冲区入库（用于代码项的大内容外部文件），不额外复制
+*           3. 移除、替换图片时无需通知存储，未保存的编辑不影响回收
+*           ==== 注意 ====
+*           1. 存活状态只由已保存的数据决定；本次运行中入库的文件（可能只被未保存的笔记使用）不会被回收
+*           2. 任一扫描器失败（如正文无法解析）时本轮不删除任何文件
+*           3. 外部文件默认复制，避免硬链接后用户修改原文件导致存储内容变化
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QObject>
+#include <QMutex>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+
+class QImage;
+class BlobStore : public QObject
+{
+    Q_OBJECT
+public:
+    // 入库方式
+    enum IngestFlag {
+        CopyOnly  = 0x0,
+        AllowLink = 0x1   // 源文件归本程序所有时允许硬链接
+    };
+    Q_DECLARE_FLAGS(IngestFlags, IngestFlag)
+
+    // 在回收线程中收集仍被引用的路径，失败时返回false
+    using ReferenceScanner = std::function<bool(QSet<QString>& paths)>;
+
+    // 单例模式
+    static BlobStore *getBlobStore()
+    {
+        static BlobStore b;
+        return &b;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    BlobStore(const BlobStore&) = delete;
+    BlobStore& operator=(const BlobStore&) = delete;
+
+    void init(const QString& blobDir);
+    QString blobDir() const;
+
+    // ======== 入库接口 ========（成功返回存储路径，失败返回空）
+    QString ingestFile(const QString& sourcePath, IngestFlags flags = CopyOnly);
+    QString ingestImage(const QImage& image, const char *format = "PNG", int quality = -1);
+    QString ingestData(const char *data, qint64 size, const QString& suffix);
+
+    bool isBlobPath(const QString& path) const;
+
+    // ======== 垃圾回收 ========
+    void addReferenceScanner(ReferenceScanner scanner);
+    void collectGarbage();
+    void setGcInterval(int msec);
+    void setGcGracePeriod(int secs) { m_gcGracePeriod = secs; }
+
+    static QString hashFile(const QString& filePath);
+
+signals:
+    void garbageCollected(int removedCount);
+
+private:
+    explicit BlobStore(QObject *parent = nullptr);
+    ~BlobStore() = default;
+
+    QString blobPathFor(const QString& hash, const QString& suffix) const;
+    QString blobKey(const QString& blobPath) const;
+    bool linkOrCopy(const QString& sourcePath, const QString& destPath, IngestFlags flags);
+    void pin(const QString& blobPath);
+
+    QString m_blobDir;
+    QSet<QString> m_pinned;     // 本次运行中入库的<哈希>.<后缀>，不参与回收
+    QVector<ReferenceScanner> m_scanners;
+    mutable QMutex m_mutex;
+    QTimer m_gcTimer;
+    bool m_gcRunning = false;
+    int m_gcGracePeriod = 24 * 3600; // 未引用图片保留的宽限期（秒）
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(BlobStore::IngestFlags)
+
+#endif // BLOBSTORE_H
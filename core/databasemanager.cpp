@@ -41,6 +41,11 @@ void DatabaseManager::init(const QString &rootPath)
     m_rootPath = rootPath;
 }
 
+QString DatabaseManager::rootPath() const
+{
+    return m_rootPath;
+}
+
 bool DatabaseManager::initDatabase()
 {
     // 首先确保数据库连接
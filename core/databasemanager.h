@@ -47,6 +47,7 @@ public:
     DatabaseManager& operator=(const DatabaseManager&) = delete;
 
     void init(const QString &rootPath);
+    QString rootPath() const;
 
     // 初始化数据库(创建所有表)
     bool initDatabase();
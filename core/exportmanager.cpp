@@ -0,0 +1,556 @@
+#include "exportmanager.h"
+
+#include "blobstore.h"
+#include "metactk.h"
+
+#include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QUrl>
+#include <QtConcurrent>
+
+ExportManager::ExportManager(QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<ExportStats>("ExportStats");
+}
+
+void ExportManager::init(const QString &rootPath)
+{
+    m_rootPath = QDir(rootPath).absolutePath();
+}
+
+bool ExportManager::startExport(const ExportSet &settings)
+{
+    if(m_running)
+    {
+        qWarning() << "An export is already running";
+        return false;
+    }
+    if(m_rootPath.isEmpty() || settings.outputDir.isEmpty())
+    {
+        qWarning() << "Export failed. No directory was specified";
+        return false;
+    }
+    // 导出目录不能位于代码库内，否则导出结果会被当作代码库内容
+    QString outputDir = QDir(settings.outputDir).absolutePath();
+    if(outputDir == m_rootPath || outputDir.startsWith(m_rootPath + "/"))
+    {
+        qWarning() << "The outputDir must not be inside the repository" << outputDir;
+        return false;
+    }
+
+    m_running = true;
+    QtConcurrent::run([=](){
+        ExportStats stats = runExport(settings);
+        QMetaObject::invokeMethod(this, [=](){
+            m_running = false;
+            qInfo() << "Export finished: total" << stats.total << "rendered" << stats.rendered
+                    << "skipped" << stats.skipped << "failed" << stats.failed
+                    << "in" << stats.elapsedMs << "ms";
+            emit exportFinished(stats.failed == 0, stats);
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+bool ExportManager::isRunning() const
+{
+    return m_running;
+}
+
+ExportStats ExportManager::runExport(const ExportSet &settings)
+{
+    QElapsedTimer timer;
+    timer.start();
+    ExportStats stats;
+
+    bool isArchive = (settings.format == "archive");
+    QString outputDir = QDir(settings.outputDir).absolutePath();
+    QString siteDir = isArchive ? outputDir + "/.export-cache" : outputDir;
+    if(!QDir().mkpath(siteDir + "/notes") || !QDir().mkpath(siteDir + "/assets"))
+    {
+        qWarning() << "Failed to create the export directory" << siteDir;
+        stats.failed = 1;
+        return stats;
+    }
+
+    QString manifestPath = siteDir + "/.export-manifest.json";
+    const QMap<QString, ManifestEntry> oldManifest = settings.incremental ? loadManifest(manifestPath)
+                                                                          : QMap<QString, ManifestEntry>();
+
+    // 收集所有笔记配置文件
+    QStringList configPaths;
+    QDirIterator it(m_rootPath, QStringList() << "meta.ctk", QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext()) configPaths.append(it.next());
+    stats.total = configPaths.size();
+
+    QMap<QString, ManifestEntry> newManifest;
+    QMutex manifestMutex;
+    QAtomicInt done = 0, rendered = 0, skipped = 0, failed = 0;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(settings.threadCount > 0 ? settings.threadCount : QThread::idealThreadCount());
+
+    const QDir rootDir(m_rootPath);
+    for(const QString &configPath : configPaths)
+    {
+        pool.start([&, configPath](){
+            QString relPath = rootDir.relativeFilePath(QFileInfo(configPath).path());
+            QString pagePath = siteDir + "/notes/" + relPath + "/index.html";
+
+            ManifestEntry entry;
+            entry.hash = BlobStore::hashFile(configPath);
+
+            auto old = oldManifest.constFind(relPath);
+            if(!entry.hash.isEmpty() && old != oldManifest.constEnd()
+                    && old->hash == entry.hash && QFile::exists(pagePath) && assetsUnchanged(*old, siteDir))
+            {
+                // 内容和引用的图片均未变化，沿用上次输出
+                entry = *old;
+                skipped++;
+            }
+            else if(!entry.hash.isEmpty() && renderNote(configPath, relPath, siteDir, &entry))
+            {
+                rendered++;
+            }
+            else
+            {
+                // 失败的笔记不写入清单，下次导出重试
+                entry.hash.clear();
+                failed++;
+            }
+
+            if(!entry.hash.isEmpty())
+            {
+                QMutexLocker locker(&manifestMutex);
+                newManifest.insert(relPath, entry);
+            }
+
+            int finished = ++done;
+            int total = configPaths.size();
+            QMetaObject::invokeMethod(this, [=](){
+                emit exportProgress(finished, total);
+            }, Qt::QueuedConnection);
+        });
+    }
+    pool.waitForDone();
+
+    // 删除已不存在的笔记的输出
+    for(auto oit = oldManifest.constBegin(); oit != oldManifest.constEnd(); oit++)
+    {
+        if(!newManifest.contains(oit.key()))
+        {
+            QFile::remove(siteDir + "/notes/" + oit.key() + "/index.html");
+            QDir(siteDir + "/notes").rmpath(oit.key()); // 只删除已空的目录
+        }
+    }
+    removeUnusedAssets(siteDir, newManifest);
+
+    stats.rendered = rendered;
+    stats.skipped = skipped;
+    stats.failed = failed;
+
+    if(!writeIndex(siteDir, newManifest) || !saveManifest(manifestPath, newManifest))
+    {
+        stats.failed++;
+    }
+    else if(isArchive)
+    {
+        QString archivePath = outputDir + "/" + rootDir.dirName() + ".tar";
+        if(!writeArchive(siteDir, archivePath)) stats.failed++;
+    }
+
+    stats.elapsedMs = timer.elapsed();
+    return stats;
+}
+
+// 渲染单个笔记页面
+bool ExportManager::renderNote(const QString &configPath, const QString &relPath,
+                               const QString &siteDir, ManifestEntry *entry)
+{
+    MetaCtk metaCtk(configPath);
+    if(!metaCtk.load()) return false;
+    CodeNote note = metaCtk.noteContent();
+    const QString title = metaCtk.projectName();
+    entry->title = title;
+    entry->assets.clear();
+
+    QString pageDir = siteDir + "/notes/" + relPath;
+    if(!QDir().mkpath(pageDir)) return false;
+    QDir dir(pageDir);
+
+    QSaveFile file(pageDir + "/index.html");
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Failed to open the file" << file.fileName();
+        return false;
+    }
+
+    // 导出图片并记录其当前状态，供下次导出判断是否需要重新渲染
+    auto addAsset = [&](const QString &imagePath) -> QString {
+        if(imagePath.isEmpty()) return "";
+        QString destPath = exportAsset(imagePath, siteDir);
+        QFileInfo info(imagePath);
+        AssetRef ref;
+        ref.source = info.absoluteFilePath();
+        if(info.isFile())
+        {
+            ref.size = info.size();
+            ref.modified = info.lastModified().toMSecsSinceEpoch();
+        }
+        if(!destPath.isEmpty()) ref.fileName = QFileInfo(destPath).fileName();
+        entry->assets.append(ref);
+        return destPath;
+    };
+
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">\n"
+        << "<title>" << escapeHtml(title) << "</title>\n"
+        << "<link rel=\"stylesheet\" href=\"" << escapeHtml(urlPath(dir.relativeFilePath(siteDir + "/style.css"))) << "\">\n"
+        << "</head><body>\n"
+        << "<p class=\"nav\"><a href=\"" << escapeHtml(urlPath(dir.relativeFilePath(siteDir + "/index.html"))) << "\">返回目录</a></p>\n"
+        << "<h1>" << escapeHtml(title) << "</h1>\n"
+        << "<p class=\"meta\">" << escapeHtml(metaCtk.author()) << " · "
+        << metaCtk.modifed().toString("yyyy-MM-dd hh:mm") << "</p>\n";
+
+    // 标签
+    if(!note.tags.isEmpty())
+    {
+        out << "<ul class=\"tags\">\n";
+        for(auto it = note.tags.constBegin(); it != note.tags.constEnd(); it++)
+        {
+            for(const QString &tag : it.value())
+            {
+                out << "<li>" << escapeHtml(it.key()) << ": " << escapeHtml(tag) << "</li>\n";
+            }
+        }
+        out << "</ul>\n";
+    }
+
+    // 内容项
+    QString demoImage = addAsset(metaCtk.demoImagePath());
+    if(!demoImage.isEmpty())
+    {
+        out << "<img class=\"demo\" src=\"" << escapeHtml(urlPath(dir.relativeFilePath(demoImage))) << "\">\n";
+    }
+    for(const NoteItem &item : note.note)
+    {
+        switch(item.type)
+        {
+        case NType::Text:
+            out << "<p class=\"text\">" << escapeHtml(item.content).replace("\n", "<br>\n") << "</p>\n";
+            break;
+        case NType::Markdown:
+            out << "<pre class=\"markdown\">" << escapeHtml(item.content) << "</pre>\n";
+            break;
+        case NType::Code:
+            out << "<pre class=\"code\"><code class=\"language-" << escapeHtml(item.language.toLower()) << "\">"
+                << escapeHtml(item.external ? readExternalContent(item.content) : item.content) << "</code></pre>\n";
+            break;
+        case NType::Image:
+        {
+            QString asset = addAsset(item.content);
+            if(!asset.isEmpty())
+                out << "<img src=\"" << escapeHtml(urlPath(dir.relativeFilePath(asset))) << "\">\n";
+            break;
+        }
+        }
+    }
+    out << "</body></html>\n";
+    out.flush();
+
+    if(!file.commit())
+    {
+        qWarning() << "Failed to write the page" << file.fileName() << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// 写入目录页和样式表
+bool ExportManager::writeIndex(const QString &siteDir, const QMap<QString, ManifestEntry> &manifest)
+{
+    QSaveFile css(siteDir + "/style.css");
+    if(css.open(QIODevice::WriteOnly))
+    {
+        css.write("body{font-family:\"Microsoft YaHei\",sans-serif;max-width:960px;margin:20px auto;padding:0 20px;}\n"
+                  "pre{background:#f5f5f5;padding:10px;overflow:auto;}\n"
+                  "img{max-width:100%;}\n"
+                  ".meta,.nav{color:#888;font-size:small;}\n"
+                  ".tags li{display:inline-block;margin-right:8px;color:#555;}\n");
+        css.commit();
+    }
+
+    QSaveFile file(siteDir + "/index.html");
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Failed to open the file" << file.fileName();
+        return false;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">\n"
+        << "<title>" << escapeHtml(QDir(m_rootPath).dirName()) << "</title>\n"
+        << "<link rel=\"stylesheet\" href=\"style.css\">\n</head><body>\n"
+        << "<h1>" << escapeHtml(QDir(m_rootPath).dirName()) << "</h1>\n<ul>\n";
+    for(auto it = manifest.constBegin(); it != manifest.constEnd(); it++)
+    {
+        out << "<li><a href=\"notes/" << escapeHtml(urlPath(it.key())) << "/index.html\">"
+            << escapeHtml(it->title.isEmpty() ? it.key() : it->title) << "</a></li>\n";
+    }
+    out << "</ul>\n</body></html>\n";
+    out.flush();
+    return file.commit();
+}
+
+// 上次渲染时引用的图片是否均未变化且仍在assets目录中
+bool ExportManager::assetsUnchanged(const ManifestEntry &entry, const QString &siteDir)
+{
+    for(const AssetRef &ref : entry.assets)
+    {
+        QFileInfo info(ref.source);
+        qint64 size = info.isFile() ? info.size() : -1;
+        if(size != ref.size) return false;
+        if(size >= 0 && info.lastModified().toMSecsSinceEpoch() != ref.modified) return false;
+        if(!ref.fileName.isEmpty() && !QFile::exists(siteDir + "/assets/" + ref.fileName)) return false;
+    }
+    return true;
+}
+
+// 删除清单中已没有笔记引用的图片
+void ExportManager::removeUnusedAssets(const QString &siteDir, const QMap<QString, ManifestEntry> &manifest)
+{
+    QSet<QString> used;
+    for(const ManifestEntry &entry : manifest)
+    {
+        for(const AssetRef &ref : entry.assets)
+        {
+            if(!ref.fileName.isEmpty()) used.insert(ref.fileName);
+        }
+    }
+
+    QDir assetsDir(siteDir + "/assets");
+    for(const QString &fileName : assetsDir.entryList(QDir::Files))
+    {
+        if(!used.contains(fileName)) assetsDir.remove(fileName);
+    }
+}
+
+// 拷贝图片到assets目录，返回导出后的路径
+QString ExportManager::exportAsset(const QString &imagePath, const QString &siteDir)
+{
+    if(imagePath.isEmpty()) return "";
+    QFileInfo info(imagePath);
+    if(!info.isFile()) return "";
+
+    // 存储内的图片已按内容命名，其他图片按路径哈希命名
+    QString fileName = BlobStore::getBlobStore()->isBlobPath(imagePath) ? info.fileName()
+            : QString(QCryptographicHash::hash(info.absoluteFilePath().toUtf8(),
+                                               QCryptographicHash::Md5).toHex().left(16))
+              + "." + info.suffix().toLower();
+    QString destPath = siteDir + "/assets/" + fileName;
+
+    QFileInfo destInfo(destPath);
+    if(destInfo.exists() && destInfo.size() == info.size()
+            && destInfo.lastModified() >= info.lastModified()) return destPath;
+
+    // 多个线程可能同时导出同一图片，使用线程独立的临时文件
+    QString tempPath = destPath + QString(".%1.tmp").arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    QFile::remove(tempPath);
+    if(!QFile::copy(imagePath, tempPath)) return "";
+    QFile::remove(destPath);
+    if(!QFile::rename(tempPath, destPath))
+    {
+        QFile::remove(tempPath);
+        if(!QFile::exists(destPath)) return "";
+    }
+    return destPath;
+}
+
+// 以ustar格式流式写入归档
+bool ExportManager::writeArchive(const QString &siteDir, const QString &archivePath)
+{
+    QSaveFile archive(archivePath);
+    if(!archive.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Failed to open the file" << archivePath;
+        return false;
+    }
+
+    auto writeHeader = [&](const QByteArray &name, qint64 size, char type, qint64 mtime) {
+        QByteArray header(512, '\0');
+        auto setField = [&](int offset, int length, const QByteArray &value) {
+            memcpy(header.data() + offset, value.constData(), qMin(length, value.size()));
+        };
+        auto octal = [](qint64 value, int width) {
+            return QByteArray::number(value, 8).rightJustified(width - 1, '0');
+        };
+        setField(0, 100, name);
+        setField(100, 8, octal(0644, 8));
+        setField(108, 8, octal(0, 8));
+        setField(116, 8, octal(0, 8));
+        setField(124, 12, octal(size, 12));
+        setField(136, 12, octal(mtime, 12));
+        setField(148, 8, QByteArray(8, ' '));
+        header[156] = type;
+        setField(257, 6, QByteArray("ustar", 6));
+        setField(263, 2, "00");
+
+        unsigned int checksum = 0;
+        for(char c : header) checksum += static_cast<unsigned char>(c);
+        setField(148, 8, octal(checksum, 7) + QByteArray(1, '\0') + " ");
+        archive.write(header);
+    };
+    auto writePadding = [&](qint64 size) {
+        if(size % 512) archive.write(QByteArray(512 - size % 512, '\0'));
+    };
+
+    QDir site(siteDir);
+    QDirIterator it(siteDir, QDir::Files, QDirIterator::Subdirectories);
+    QByteArray buffer;
+    while(it.hasNext())
+    {
+        QString path = it.next();
+        QString relPath = site.relativeFilePath(path);
+        if(relPath.startsWith(".export-manifest") || relPath.endsWith(".tmp")) continue;
+
+        QFile file(path);
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            qWarning() << "Failed to open the file" << path;
+            return false;
+        }
+        QByteArray name = relPath.toUtf8();
+        qint64 mtime = it.fileInfo().lastModified().toSecsSinceEpoch();
+        // 超长路径使用GNU LongLink扩展
+        if(name.size() >= 100)
+        {
+            writeHeader("././@LongLink", name.size() + 1, 'L', 0);
+            archive.write(name + '\0');
+            writePadding(name.size() + 1);
+        }
+        writeHeader(name, file.size(), '0', mtime);
+
+        qint64 written = 0;
+        while(!file.atEnd())
+        {
+            buffer = file.read(64 * 1024);
+            archive.write(buffer);
+            written += buffer.size();
+        }
+        writePadding(written);
+    }
+    archive.write(QByteArray(1024, '\0'));
+
+    if(!archive.commit())
+    {
+        qWarning() << "Failed to write the archive" << archivePath << archive.errorString();
+        return false;
+    }
+    return true;
+}
+
+QMap<QString, ExportManager::ManifestEntry> ExportManager::loadManifest(const QString &manifestPath)
+{
+    QMap<QString, ManifestEntry> manifest;
+    QFile file(manifestPath);
+    if(!file.open(QIODevice::ReadOnly)) return manifest;
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    for(auto it = root.begin(); it != root.end(); it++)
+    {
+        QJsonObject obj = it.value().toObject();
+        // 旧版清单没有记录引用的图片，无法判断是否变化，视为需要重新渲染
+        if(!obj.contains("assets")) continue;
+        ManifestEntry entry;
+        entry.hash = obj["hash"].toString();
+        entry.title = obj["title"].toString();
+        for(const QJsonValue &value : obj["assets"].toArray())
+        {
+            QJsonObject assetObj = value.toObject();
+            AssetRef ref;
+            ref.source = assetObj["source"].toString();
+            ref.size = static_cast<qint64>(assetObj["size"].toDouble(-1));
+            ref.modified = static_cast<qint64>(assetObj["modified"].toDouble());
+            ref.fileName = assetObj["file"].toString();
+            entry.assets.append(ref);
+        }
+        manifest.insert(it.key(), entry);
+    }
+    return manifest;
+}
+
+bool ExportManager::saveManifest(const QString &manifestPath, const QMap<QString, ManifestEntry> &manifest)
+{
+    QJsonObject root;
+    for(auto it = manifest.constBegin(); it != manifest.constEnd(); it++)
+    {
+        QJsonObject obj;
+        obj["hash"] = it->hash;
+        obj["title"] = it->title;
+        QJsonArray assets;
+        for(const AssetRef &ref : it->assets)
+        {
+            QJsonObject assetObj;
+            assetObj["source"] = ref.source;
+            assetObj["size"] = static_cast<double>(ref.size);
+            assetObj["modified"] = static_cast<double>(ref.modified);
+            assetObj["file"] = ref.fileName;
+            assets.append(assetObj);
+        }
+        obj["assets"] = assets;
+        root[it.key()] = obj;
+    }
+
+    QSaveFile file(manifestPath);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Failed to open the file" << manifestPath;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+QString ExportManager::escapeHtml(const QString &text)
+{
+    return text.toHtmlEscaped();
+}
+
+// 按路径段进行URL编码，避免#、?、%等字符破坏链接
+QString ExportManager::urlPath(const QString &path)
+{
+    QStringList segments = path.split('/');
+    for(QString &segment : segments)
+    {
+        segment = QString::fromLatin1(QUrl::toPercentEncoding(segment));
+    }
+    return segments.join('/');
+}
+
+// 外部存储的大内容（UTF-8文本）
+QString ExportManager::readExternalContent(const QString &filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Failed to read the external content" << filePath << file.errorString();
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
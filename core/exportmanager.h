@@ -0,0 +1,109 @@
+#ifndef EXPORTMANAGER_H
+#define EXPORTMANAGER_H
+/*****************************************************
+*
+* @file     exportmanager.h
+* @brief    代码库导出类（单例）
+*
+* @description
+*           ==== 核心功能 ====
+*           - 将代码库中所有meta.ctk笔记导出为静态HTML站点或单个tar归档
+*           - 线程池并行渲染笔记，整个导出在后台线程执行
+*           - 清单文件(.export-manifest.json)记录每个笔记的内容哈希及引用图片的大小/修改时间，
+*             均未变化的笔记跳过；不再被引用的assets文件在导出结束时清除
+*           - 输出均为流式写入（QSaveFile/QTextStream），不在内存中拼接整个站点或归档
+*           ==== 目录结构 ====
+*           html：   <outputDir>/index.html
+*                    <outputDir>/notes/<相对路径>/index.html
+*                    <outputDir>/assets/<图片>
+*           archive：<outputDir>/.export-cache/  渲染缓存（结构同html）
+*                    <outputDir>/<代码库名>.tar
+*           ==== 使用说明 ====
+*           1. 启动时调用init()设置代码库根目录
+*           2. startExport()开始导出，通过exportProgress/exportFinished获取进度和结果
+*           ==== 注意 ====
+*           同一时间只允许一个导出任务
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QObject>
+#include <QMap>
+#include "settings_types.h"
+
+// 导出结果统计
+struct ExportStats {
+    int total = 0;      // 笔记总数
+    int rendered = 0;   // 重新渲染数
+    int skipped = 0;    // 未变化跳过数
+    int failed = 0;     // 失败数
+    qint64 elapsedMs = 0;
+};
+
+class ExportManager : public QObject
+{
+    Q_OBJECT
+public:
+    // 单例模式
+    static ExportManager *getExportManager()
+    {
+        static ExportManager e;
+        return &e;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    ExportManager(const ExportManager&) = delete;
+    ExportManager& operator=(const ExportManager&) = delete;
+
+    void init(const QString& rootPath);
+
+    bool startExport(const ExportSet& settings);
+    bool isRunning() const;
+
+signals:
+    void exportProgress(int done, int total);
+    void exportFinished(bool success, const ExportStats& stats);
+
+private:
+    explicit ExportManager(QObject *parent = nullptr);
+
+    // 笔记引用的图片
+    struct AssetRef {
+        QString source;     // 原图片路径
+        qint64 size = -1;   // 渲染时的大小，-1表示当时不存在
+        qint64 modified = 0;// 渲染时的修改时间(ms)
+        QString fileName;   // assets目录下的文件名，未导出时为空
+    };
+
+    // 清单项：一个笔记的导出记录
+    struct ManifestEntry {
+        QString hash;           // meta.ctk内容哈希
+        QString title;          // 项目名（用于索引页）
+        QList<AssetRef> assets; // 引用的图片
+    };
+
+    // 导出任务（后台线程执行）
+    ExportStats runExport(const ExportSet& settings);
+    bool renderNote(const QString& configPath, const QString& relPath,
+                    const QString& siteDir, ManifestEntry *entry);
+    bool assetsUnchanged(const ManifestEntry& entry, const QString& siteDir);
+    void removeUnusedAssets(const QString& siteDir, const QMap<QString, ManifestEntry>& manifest);
+    bool writeIndex(const QString& siteDir, const QMap<QString, ManifestEntry>& manifest);
+    QString exportAsset(const QString& imagePath, const QString& siteDir);
+    bool writeArchive(const QString& siteDir, const QString& archivePath);
+
+    QMap<QString, ManifestEntry> loadManifest(const QString& manifestPath);
+    bool saveManifest(const QString& manifestPath, const QMap<QString, ManifestEntry>& manifest);
+
+    static QString escapeHtml(const QString& text);
+    static QString urlPath(const QString& path);
+    static QString readExternalContent(const QString& filePath);
+
+    QString m_rootPath;
+    bool m_running = false;
+};
+
+Q_DECLARE_METATYPE(ExportStats)
+
+#endif // EXPORTMANAGER_H
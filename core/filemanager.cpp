@@ -4,9 +4,15 @@
 #include <QTextStream>
 #include <QDebug>
 #include <QRegularExpression>
+#include <QFileSystemWatcher>
 
 FileManager::FileManager(QObject *parent) : QObject(parent)
 {
+    m_cacheClock.start();
+    // 磁盘被外部修改时使对应目录缓存失效
+    m_watcher = new QFileSystemWatcher(this);
+    QObject::connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+                     this, &FileManager::invalidateDirCache);
 }
 
 // 添加项目文件（含配置文件和隐藏文件）返回当前文件名，无效返回空
@@ -31,10 +37,12 @@ QString FileManager::createProject(const QString &destDir)
         qWarning() << "Failed to create the project folder";
         return "";
     }
+    invalidateDirCache(destDir);
     // == 2. 添加隐藏文件 ==
     if(!addRepoId(filePath) || !addRepoIdFile(destDir))
     {
         dir.rmdir(fileName);// 回滚
+        invalidateDirCache(destDir);
         return "";
     }
     // == 3. 添加配置文件 ==
@@ -43,6 +51,7 @@ QString FileManager::createProject(const QString &destDir)
     {
         file.close();
     }
+    invalidateDirCache(filePath);
     emit createMetaCtk(filePath + "/meta.ctk", fileName);
 
     return fileName;
@@ -70,10 +79,12 @@ QString FileManager::createCategory(const QString &destDir)
         qWarning() << "Failed to create a category";
         return "";
     }
+    invalidateDirCache(destDir);
     // == 2. 添加隐藏文件 ==
     if(!addRepoId(dirPath) || !addRepoIdDir(destDir))
     {
         dir.rmdir(dirName);// 回滚
+        invalidateDirCache(destDir);
         return "";
     }
     return dirName;
@@ -184,6 +195,7 @@ bool FileManager::importFolder(const QString &sourceDir, const QString &destDir)
         qWarning() << "Failed to create the directory";
         return false;
     }
+    invalidateDirCache(dest.path());
     // 复制内容
     bool success = true;
     QFileInfoList entries = srcDir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
@@ -198,6 +210,7 @@ bool FileManager::importFolder(const QString &sourceDir, const QString &destDir)
         }
         else success = success && QFile::copy(srcPath, newDestPath);
     }
+    invalidateDirCache(destPath);
     if(!success)
     {
         removeRecursively(destPath);
@@ -244,6 +257,7 @@ bool FileManager::removeItem(const QString &path)
                 // 删除标识文件（保留REPO_ID）
                 QFile::remove(parentDir + "/" + REPO_ID_FILE);
                 QFile::remove(parentDir + "/" + REPO_ID_DIR);
+                invalidateDirCache(parentDir);
             }
         }
     }
@@ -254,13 +268,13 @@ bool FileManager::removeItem(const QString &path)
 // 判断是否为代码库项目文件/文件夹
 bool FileManager::isRepositoryItem(const QString &destDir)
 {
-    return QFile::exists(destDir + "/" + REPO_ID);
+    return dirContains(destDir, REPO_ID);
 }
 
 // 判断是否为项目文件
 bool FileManager::isProject(const QString &destDir)
 {
-    return isRepositoryItem(destDir) && QFile::exists(destDir + "/meta.ctk");
+    return isRepositoryItem(destDir) && dirContains(destDir, "meta.ctk");
 }
 
 // 判断是否为分类目录
@@ -272,7 +286,7 @@ bool FileManager::isCategory(const QString &destDir)
 // 判断是否命名重复
 bool FileManager::hasNameRepetition(const QString &name, const QString& destDir)
 {
-    return QDir(destDir).exists(name);
+    return dirContains(destDir, name);
 }
 
 // 判断是否是代码文件
@@ -307,12 +321,12 @@ bool FileManager::isImageFile(const QString &filePath)
 
 bool FileManager::hasProjectMarker(const QString &destDir)
 {
-    return QFile::exists(destDir + "/" + REPO_ID_FILE);
+    return dirContains(destDir, REPO_ID_FILE);
 }
 
 bool FileManager::hasCategoryMarker(const QString &destDir)
 {
-    return QFile::exists(destDir + "/" + REPO_ID_DIR);
+    return dirContains(destDir, REPO_ID_DIR);
 }
 
 // 检测命名重复，自动重命名
@@ -322,16 +336,17 @@ QString FileManager::autoRename(const QString &name, const QString &path)
     QString sanitizedName = sanitizeFileName(name);
     if(sanitizedName.isEmpty()) return "";
 
+    // 一次列目录，候选名均在内存中判断
+    const QSet<QString> entries = dirListing(path).entries;
     if(isProject(path))
     {
         QFileInfo info(sanitizedName);
         QString base = info.completeBaseName();
         QString suffix = info.suffix();
         QString newName = sanitizedName;
-        QDir dir(path);
         int count = 0;
 
-        while(dir.exists(newName))
+        while(entries.contains(entryKey(newName)))
         {
             newName = QString("%1%2%3")
                     .arg(base).arg(++count).arg(suffix.isEmpty() ? "" : "." + suffix);
@@ -342,10 +357,9 @@ QString FileManager::autoRename(const QString &name, const QString &path)
     {
         QString base = sanitizedName;
         QString newName = sanitizedName;
-        QDir dir(path);
         int count = 0;
 
-        while(dir.exists(newName))
+        while(entries.contains(entryKey(newName)))
         {
             newName = QString("%1%2").arg(base).arg(++count);
         }
@@ -384,6 +398,8 @@ bool FileManager::renameItem(const QString &newName, const QString &path)
     if(isProject(path))
     {
         parentDir.rename(fileInfo.fileName(), sanitizedName);
+        invalidateDirCache(parentDir.path());
+        invalidateDirCache(path);
         // 对m_metaCtk进行重配置
         QFile file(newPath + "/meta.ctk");
         if(file.open(QIODevice::WriteOnly))
@@ -396,6 +412,8 @@ bool FileManager::renameItem(const QString &newName, const QString &path)
     else if(isCategory(path))
     {
         parentDir.rename(fileInfo.fileName(), sanitizedName);
+        invalidateDirCache(parentDir.path());
+        invalidateDirCache(path);
     }
     else
     {
@@ -469,7 +487,10 @@ bool FileManager::removeRecursively(const QString &path)
         }
     }
 
-    return success && dir.rmdir(path);
+    success = success && dir.rmdir(path);
+    invalidateDirCache(path);
+    invalidateDirCache(QFileInfo(path).path());
+    return success;
 }
 
 // 添加隐藏标识文件
@@ -482,6 +503,7 @@ bool FileManager::addRepoIdFile(const QString &path)
         return false;
     }
     file.close();
+    invalidateDirCache(path);
     return true;
 
 }
@@ -495,6 +517,7 @@ bool FileManager::addRepoIdDir(const QString &path)
         return false;
     }
     file.close();
+    invalidateDirCache(path);
     return true;
 }
 
@@ -507,5 +530,104 @@ bool FileManager::addRepoId(const QString &path)
         return false;
     }
     file.close();
+    invalidateDirCache(path);
     return true;
 }
+
+// 使目录缓存失效
+void FileManager::invalidateDirCache(const QString &dirPath)
+{
+    QString key = dirCacheKey(dirPath);
+    if(m_dirCache.remove(key) > 0)
+    {
+        m_dirCacheStats.invalidations++;
+        if(m_watcher->directories().contains(key)) m_watcher->removePath(key);
+    }
+}
+
+void FileManager::clearDirCache()
+{
+    m_dirCacheStats.invalidations += m_dirCache.size();
+    m_dirCache.clear();
+    if(!m_watcher->directories().isEmpty()) m_watcher->removePaths(m_watcher->directories());
+}
+
+DirCacheStats FileManager::dirCacheStats() const
+{
+    return m_dirCacheStats;
+}
+
+void FileManager::resetDirCacheStats()
+{
+    m_dirCacheStats = DirCacheStats();
+}
+
+// 获取目录列表，过期或不存在时重新读取
+const FileManager::DirListing &FileManager::dirListing(const QString &dirPath)
+{
+    QString key = dirCacheKey(dirPath);
+    qint64 now = m_cacheClock.elapsed();
+
+    auto it = m_dirCache.find(key);
+    if(it != m_dirCache.end() && now - it->stamp <= m_dirCacheTtl)
+    {
+        m_dirCacheStats.hits++;
+        return it.value();
+    }
+    m_dirCacheStats.misses++;
+
+    // 缓存已满：先清理过期项，仍满则全部清空
+    if(it == m_dirCache.end() && m_dirCache.size() >= m_dirCacheLimit)
+    {
+        for(auto cit = m_dirCache.begin(); cit != m_dirCache.end();)
+        {
+            if(now - cit->stamp > m_dirCacheTtl)
+            {
+                m_watcher->removePath(cit.key());
+                cit = m_dirCache.erase(cit);
+            }
+            else cit++;
+        }
+        if(m_dirCache.size() >= m_dirCacheLimit) clearDirCache();
+    }
+
+    DirListing listing;
+    listing.stamp = now;
+    QDir dir(key);
+    listing.exists = !key.isEmpty() && dir.exists();
+    if(listing.exists)
+    {
+        const QStringList names = dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot
+                                                | QDir::Hidden | QDir::System);
+        listing.entries.reserve(names.size());
+        for(const QString &name : names)
+        {
+            listing.entries.insert(entryKey(name));
+        }
+        if(!m_watcher->directories().contains(key)) m_watcher->addPath(key);
+    }
+
+    it = m_dirCache.insert(key, listing);
+    return it.value();
+}
+
+bool FileManager::dirContains(const QString &dirPath, const QString &name)
+{
+    return dirListing(dirPath).entries.contains(entryKey(name));
+}
+
+QString FileManager::dirCacheKey(const QString &dirPath)
+{
+    if(dirPath.isEmpty()) return QString();
+    return QDir::cleanPath(QDir(dirPath).absolutePath());
+}
+
+// Windows文件系统不区分大小写
+QString FileManager::entryKey(const QString &name)
+{
+#ifdef Q_OS_WIN
+    return name.toLower();
+#else
+    return name;
+#endif
+}
@@ -27,10 +27,14 @@
 *           1. 所有路径参数均支持相对路径
 *           2. 添加文件时自动处理项目结构创建
 *           3. 图片文件仅可作为项目演示图添加（每个项目限1张）
+*           ====== 目录缓存 ======
+*           1. 验证接口与autoRename通过短时目录列表缓存回答，避免同一次操作中重复stat
+*           2. 缓存项在超时(m_dirCacheTtl)、自身修改操作、监视器通知时失效
+*           3. dirCacheStats()提供命中/未命中/失效计数，用于验证命中率
 *           ====== 注意 ======
 *           当前版本仅支持标准项目结构的文件夹操作
 *           非项目结构文件夹需手动转换
-*           目前没有针对磁盘文件被手动改变的处理
+*           磁盘文件被手动改变时依赖QFileSystemWatcher使缓存失效
 *
 * @author   无声目
 * @date     2025/08/15
@@ -38,8 +42,26 @@
 *****************************************************/
 
 #include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
 #include "code_types.h"
 
+class QFileSystemWatcher;
+
+// 目录缓存统计
+struct DirCacheStats {
+    quint64 hits = 0;           // 命中次数
+    quint64 misses = 0;         // 未命中次数（重新列目录）
+    quint64 invalidations = 0;  // 失效次数
+
+    double hitRate() const
+    {
+        quint64 total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+};
+
 class FileManager : public QObject
 {
     Q_OBJECT
@@ -76,6 +98,14 @@ public:
     bool renameItem(const QString& newName, const QString& path);
     QString sanitizeFileName(const QString &fileName);
 
+    // ======== 目录缓存接口 ========
+    void invalidateDirCache(const QString& dirPath);
+    void clearDirCache();
+    DirCacheStats dirCacheStats() const;
+    void resetDirCacheStats();
+    void setDirCacheTtl(int msec) { m_dirCacheTtl = msec; }
+    int dirCacheTtl() const { return m_dirCacheTtl; }
+
     // ======== 查询接口 ========（用到再写）
     // 查询项目文件信息：文件大小，内有文件数量，
     //QVariantMap getProjectFileInfo(const QString& filePath);
@@ -98,6 +128,24 @@ private:
     bool addRepoIdDir(const QString& path);         // 添加隐藏标识文件
     bool addRepoId(const QString& path);            // 添加隐藏标识文件
 
+    // 目录列表缓存项
+    struct DirListing {
+        QSet<QString> entries;  // 目录下的条目名（含隐藏文件）
+        bool exists = false;
+        qint64 stamp = 0;       // 缓存时刻（m_cacheClock毫秒）
+    };
+    const DirListing &dirListing(const QString& dirPath); // 获取（必要时刷新）目录列表
+    bool dirContains(const QString& dirPath, const QString& name);
+    static QString dirCacheKey(const QString& dirPath);
+    static QString entryKey(const QString& name);
+
+    QHash<QString, DirListing> m_dirCache;
+    QFileSystemWatcher *m_watcher = nullptr;
+    QElapsedTimer m_cacheClock;
+    DirCacheStats m_dirCacheStats;
+    int m_dirCacheTtl = 2000;       // 缓存有效期（毫秒）
+    int m_dirCacheLimit = 256;      // 最大缓存目录数
+
     // 默认命名配置
     QString m_defaultFileName = "untitle";
     QString m_defaultDirName = "分类";
@@ -0,0 +1,411 @@
+#include "historymanager.h"
+#include "metactk.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <cstring>
+
+namespace {
+const int BLOCK_SIZE = 16;
+const qint64 MAX_CONTENT_SIZE = 512 * 1024 * 1024; // 还原内容的上限，超过视为数据损坏
+enum DeltaOp : quint8 {
+    Copy   = 1,
+    Insert = 2
+};
+
+void writeInsert(QDataStream &stream, const QByteArray &target, int begin, int end)
+{
+    if(end <= begin) return;
+    stream << quint8(Insert) << quint32(end - begin);
+    stream.writeRawData(target.constData() + begin, end - begin);
+}
+}
+
+HistoryManager::HistoryManager(QObject *parent) : QObject(parent)
+{
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(-1);
+}
+
+HistoryManager::~HistoryManager()
+{
+    flush();
+}
+
+void HistoryManager::init(const QString &historyDir)
+{
+    m_historyDir = QDir(historyDir).absolutePath();
+    if(!QDir().mkpath(m_historyDir))
+    {
+        qWarning() << "Failed to create the history directory" << m_historyDir;
+        m_historyDir.clear();
+        return;
+    }
+    qInfo() << "HistoryManager initialized" << m_historyDir;
+}
+
+// 在调用线程序列化，差量计算和写入在后台完成
+void HistoryManager::recordRevision(const QString &uuid, const CodeNote &codeNote)
+{
+    if(m_historyDir.isEmpty() || uuid.isEmpty()) return;
+
+    QByteArray content = QJsonDocument(MetaCtk::noteToJson(codeNote)).toJson(QJsonDocument::Compact);
+    QSet<QString> blobPaths;
+    for(const NoteItem &item : codeNote.note)
+    {
+        if(item.type == NType::Image || item.external) blobPaths.insert(item.content);
+    }
+    m_pool.start([=](){
+        writeRevision(uuid, content, blobPaths);
+    });
+}
+
+QVector<RevisionInfo> HistoryManager::revisions(const QString &uuid) const
+{
+    QVector<RevisionInfo> result;
+    QVector<IndexEntry> entries;
+    {
+        QMutexLocker locker(&m_mutex);
+        entries = readIndex(uuid);
+    }
+    result.reserve(entries.size());
+    for(int i = 0; i < entries.size(); i++)
+    {
+        RevisionInfo info;
+        info.index = i;
+        info.time = QDateTime::fromMSecsSinceEpoch(entries[i].time);
+        info.size = entries[i].size;
+        info.storedSize = entries[i].length;
+        info.isSnapshot = entries[i].isSnapshot;
+        result.append(info);
+    }
+    return result;
+}
+
+CodeNote HistoryManager::restoreRevision(const QString &uuid, int index, bool *ok) const
+{
+    QByteArray content;
+    bool success = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        content = reconstruct(uuid, readIndex(uuid), index, &success);
+    }
+    if(ok) *ok = success;
+    if(!success) return CodeNote();
+    return MetaCtk::jsonToNote(QJsonDocument::fromJson(content).object());
+}
+
+void HistoryManager::flush()
+{
+    m_pool.waitForDone();
+}
+
+// 汇总所有笔记历史版本引用的路径，读取失败返回false（此时不能回收）
+bool HistoryManager::collectBlobReferences(QSet<QString> &paths) const
+{
+    if(m_historyDir.isEmpty()) return true;
+
+    QMutexLocker locker(&m_mutex);
+    const QStringList files = QDir(m_historyDir).entryList(QStringList() << "*.refs", QDir::Files);
+    for(const QString &fileName : files)
+    {
+        QFile file(m_historyDir + "/" + fileName);
+        if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            qWarning() << "Failed to open the file" << file.fileName();
+            return false;
+        }
+        for(const QString &line : QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts))
+        {
+            paths.insert(line);
+        }
+    }
+    return true;
+}
+
+// 工作线程：计算差量并追加到数据文件和索引
+void HistoryManager::writeRevision(const QString &uuid, const QByteArray &content, const QSet<QString> &blobPaths)
+{
+    QMutexLocker locker(&m_mutex);
+    QVector<IndexEntry> entries = readIndex(uuid);
+
+    quint64 hash = contentHash(content);
+    if(!entries.isEmpty() && entries.last().hash == hash) return; // 内容未变化
+
+    // 先记录引用再写版本，版本可见时它引用的文件一定不会被回收
+    if(!appendReferences(uuid, blobPaths)) return;
+
+    IndexEntry entry;
+    entry.time = QDateTime::currentMSecsSinceEpoch();
+    entry.size = content.size();
+    entry.hash = hash;
+
+    QByteArray payload = qCompress(content);
+    entry.isSnapshot = 1;
+    if(!entries.isEmpty() && entries.size() % SNAPSHOT_INTERVAL != 0)
+    {
+        // 上一版本的内容：连续记录同一笔记时直接使用缓存
+        bool ok = true;
+        QByteArray previous = (m_lastUuid == uuid) ? m_lastContent
+                                                   : reconstruct(uuid, entries, entries.size() - 1, &ok);
+        if(ok)
+        {
+            QByteArray delta = qCompress(encodeDelta(previous, content));
+            if(delta.size() < payload.size())
+            {
+                payload = delta;
+                entry.isSnapshot = 0;
+            }
+        }
+    }
+
+    QFile dataFile(dataPath(uuid));
+    if(!dataFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qWarning() << "Failed to open the file" << dataFile.fileName();
+        return;
+    }
+    entry.offset = dataFile.size();
+    entry.length = payload.size();
+    if(dataFile.write(payload) != payload.size())
+    {
+        qWarning() << "Failed to write the revision" << dataFile.fileName();
+        dataFile.resize(entry.offset);
+        return;
+    }
+    dataFile.close();
+
+    // 数据写入后再写索引，崩溃时最多丢失最后一个版本
+    QFile indexFile(indexPath(uuid));
+    if(!indexFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qWarning() << "Failed to open the file" << indexFile.fileName();
+        return;
+    }
+    // 截掉崩溃遗留的不完整记录，保证记录对齐
+    indexFile.resize(qint64(entries.size()) * INDEX_ENTRY_SIZE);
+    indexFile.seek(indexFile.size());
+    QDataStream stream(&indexFile);
+    stream << entry.time << entry.offset << entry.length << entry.size << entry.hash << entry.isSnapshot;
+    indexFile.close();
+
+    m_lastUuid = uuid;
+    m_lastContent = content;
+
+    int index = entries.size();
+    QMetaObject::invokeMethod(this, [=](){
+        emit revisionRecorded(uuid, index);
+    }, Qt::QueuedConnection);
+}
+
+// 只追加尚未记录的路径
+bool HistoryManager::appendReferences(const QString &uuid, const QSet<QString> &blobPaths)
+{
+    if(blobPaths.isEmpty()) return true;
+
+    QFile file(refsPath(uuid));
+    if(!file.open(QIODevice::ReadWrite | QIODevice::Text))
+    {
+        qWarning() << "Failed to open the file" << file.fileName();
+        return false;
+    }
+    QByteArray existing = file.readAll();
+    const QStringList recorded = QString::fromUtf8(existing).split('\n', Qt::SkipEmptyParts);
+    QSet<QString> known(recorded.begin(), recorded.end());
+
+    QByteArray added;
+    for(const QString &path : blobPaths)
+    {
+        if(!path.isEmpty() && !known.contains(path)) added += path.toUtf8() + '\n';
+    }
+    if(added.isEmpty()) return true;
+    // 崩溃遗留的半行补上换行，不与新路径连在一起
+    if(!existing.isEmpty() && !existing.endsWith('\n')) added.prepend('\n');
+    if(file.write(added) != added.size())
+    {
+        qWarning() << "Failed to write the references" << file.fileName();
+        return false;
+    }
+    return true;
+}
+
+QVector<HistoryManager::IndexEntry> HistoryManager::readIndex(const QString &uuid) const
+{
+    QVector<IndexEntry> entries;
+    QFile file(indexPath(uuid));
+    if(!file.open(QIODevice::ReadOnly)) return entries;
+
+    // 忽略末尾不完整的记录
+    int count = file.size() / INDEX_ENTRY_SIZE;
+    entries.reserve(count);
+    QDataStream stream(&file);
+    for(int i = 0; i < count; i++)
+    {
+        IndexEntry entry;
+        stream >> entry.time >> entry.offset >> entry.length >> entry.size >> entry.hash >> entry.isSnapshot;
+        entries.append(entry);
+    }
+    return entries;
+}
+
+// 从最近的快照开始依次应用差量
+QByteArray HistoryManager::reconstruct(const QString &uuid, const QVector<IndexEntry> &entries,
+                                       int index, bool *ok) const
+{
+    *ok = false;
+    if(index < 0 || index >= entries.size()) return QByteArray();
+
+    int start = index;
+    while(start > 0 && !entries[start].isSnapshot) start--;
+
+    QFile dataFile(dataPath(uuid));
+    if(!dataFile.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Failed to open the file" << dataFile.fileName();
+        return QByteArray();
+    }
+
+    QByteArray content;
+    for(int i = start; i <= index; i++)
+    {
+        const IndexEntry &entry = entries[i];
+        if(!dataFile.seek(entry.offset)) return QByteArray();
+        QByteArray payload = qUncompress(dataFile.read(entry.length));
+        if(entry.isSnapshot) content = payload;
+        else
+        {
+            bool applied = false;
+            content = applyDelta(content, payload, &applied);
+            if(!applied) return QByteArray();
+        }
+    }
+    *ok = contentHash(content) == entries[index].hash;
+    return content;
+}
+
+QString HistoryManager::dataPath(const QString &uuid) const
+{
+    return m_historyDir + "/" + uuid + ".hist";
+}
+
+QString HistoryManager::indexPath(const QString &uuid) const
+{
+    return m_historyDir + "/" + uuid + ".idx";
+}
+
+QString HistoryManager::refsPath(const QString &uuid) const
+{
+    return m_historyDir + "/" + uuid + ".refs";
+}
+
+quint64 HistoryManager::contentHash(const QByteArray &content)
+{
+    QByteArray digest = QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+    quint64 hash;
+    std::memcpy(&hash, digest.constData(), sizeof(hash));
+    return hash;
+}
+
+// 按块哈希在旧版本中查找匹配，匹配后向前后扩展，未匹配的字节作为插入
+QByteArray HistoryManager::encodeDelta(const QByteArray &base, const QByteArray &target)
+{
+    QHash<uint, int> blocks;
+    blocks.reserve(base.size() / BLOCK_SIZE);
+    for(int offset = 0; offset + BLOCK_SIZE <= base.size(); offset += BLOCK_SIZE)
+    {
+        uint hash = qHashBits(base.constData() + offset, BLOCK_SIZE);
+        if(!blocks.contains(hash)) blocks.insert(hash, offset);
+    }
+
+    QByteArray delta;
+    QDataStream stream(&delta, QIODevice::WriteOnly);
+    stream << quint32(target.size());
+
+    const char *baseData = base.constData();
+    const char *targetData = target.constData();
+    int insertBegin = 0;
+    int pos = 0;
+    while(pos + BLOCK_SIZE <= target.size())
+    {
+        auto it = blocks.constFind(qHashBits(targetData + pos, BLOCK_SIZE));
+        if(it == blocks.constEnd() || std::memcmp(baseData + it.value(), targetData + pos, BLOCK_SIZE) != 0)
+        {
+            pos++;
+            continue;
+        }
+
+        int baseBegin = it.value();
+        int targetBegin = pos;
+        // 向前扩展（吃掉待插入的字节）
+        while(baseBegin > 0 && targetBegin > insertBegin
+              && baseData[baseBegin - 1] == targetData[targetBegin - 1])
+        {
+            baseBegin--;
+            targetBegin--;
+        }
+        // 向后扩展
+        int length = pos + BLOCK_SIZE - targetBegin;
+        while(baseBegin + length < base.size() && targetBegin + length < target.size()
+              && baseData[baseBegin + length] == targetData[targetBegin + length])
+        {
+            length++;
+        }
+
+        writeInsert(stream, target, insertBegin, targetBegin);
+        stream << quint8(Copy) << quint32(baseBegin) << quint32(length);
+        pos = targetBegin + length;
+        insertBegin = pos;
+    }
+    writeInsert(stream, target, insertBegin, target.size());
+    return delta;
+}
+
+QByteArray HistoryManager::applyDelta(const QByteArray &base, const QByteArray &delta, bool *ok)
+{
+    if(ok) *ok = false;
+    QDataStream stream(delta);
+    quint32 targetSize;
+    stream >> targetSize;
+    // 长度字段来自磁盘，分配前先校验，避免损坏的数据导致超大分配或越界读取
+    if(stream.status() != QDataStream::Ok || qint64(targetSize) > MAX_CONTENT_SIZE) return QByteArray();
+
+    QByteArray target;
+    // 预留空间只作提示，按实际数据量封顶
+    target.reserve(int(qMin(qint64(targetSize), qint64(base.size()) + delta.size())));
+    while(!stream.atEnd())
+    {
+        quint8 op;
+        quint32 length;
+        stream >> op;
+        if(op == Copy)
+        {
+            quint32 offset;
+            stream >> offset >> length;
+            if(stream.status() != QDataStream::Ok) return QByteArray();
+            if(qint64(offset) + qint64(length) > qint64(base.size())) return QByteArray();
+            if(qint64(target.size()) + qint64(length) > qint64(targetSize)) return QByteArray();
+            target.append(base.constData() + offset, int(length));
+        }
+        else if(op == Insert)
+        {
+            stream >> length;
+            if(stream.status() != QDataStream::Ok) return QByteArray();
+            qint64 remaining = delta.size() - stream.device()->pos();
+            if(qint64(length) > remaining) return QByteArray();
+            if(qint64(target.size()) + qint64(length) > qint64(targetSize)) return QByteArray();
+            QByteArray bytes(int(length), Qt::Uninitialized);
+            if(stream.readRawData(bytes.data(), int(length)) != int(length)) return QByteArray();
+            target.append(bytes);
+        }
+        else return QByteArray();
+        if(stream.status() != QDataStream::Ok) return QByteArray();
+    }
+    if(quint32(target.size()) != targetSize) return QByteArray();
+    if(ok) *ok = true;
+    return target;
+}
@@ -0,0 +1,110 @@
+#ifndef HISTORYMANAGER_H
+#define HISTORYMANAGER_H
+/*****************************************************
+*
+* @file     historymanager.h
+* @brief    笔记历史版本管理类（单例）
+*
+* @description
+*           ==== 核心功能 ====
+*           - 每次保存笔记时记录一个版本，按笔记UUID分别存储
+*           - 版本以二进制差量（相对上一版本）存储，每SNAPSHOT_INTERVAL个版本存一次完整快照，
+*             恢复任意版本最多应用SNAPSHOT_INTERVAL-1个差量
+*           - 列出历史只读取索引文件（定长记录），不解码内容
+*           - 记录版本在后台线程执行
+*           ==== 目录结构 ====
+*           <historyDir>/<UUID>.hist  数据：快照和差量（qCompress压缩），只追加
+*           <historyDir>/<UUID>.idx   索引：每个版本一条定长记录
+*           <historyDir>/<UUID>.refs  各版本引用的图片和外部内容路径，每行一个，只追加
+*           ==== 差量格式 ====
+*           COPY(旧版本偏移, 长度) / INSERT(字节) 指令序列，按16字节块哈希匹配旧版本
+*           ==== 使用说明 ====
+*           1. 启动时调用init()设置存储目录
+*           2. recordRevision()记录版本，内容与上一版本相同时跳过
+*           3. revisions()列出历史，restoreRevision()取得某个版本的笔记内容
+*           4. BlobStore回收前调用collectBlobReferences()，历史版本引用的文件不会被删除
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QDateTime>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+#include "code_types.h"
+
+// 版本信息
+struct RevisionInfo {
+    int index = -1;             // 版本序号（从0开始）
+    QDateTime time;             // 记录时间
+    qint64 size = 0;            // 内容大小（字节）
+    qint64 storedSize = 0;      // 实际占用大小（压缩后）
+    bool isSnapshot = false;    // 是否为完整快照
+};
+
+class HistoryManager : public QObject
+{
+    Q_OBJECT
+public:
+    // 单例模式
+    static HistoryManager *getHistoryManager()
+    {
+        static HistoryManager h;
+        return &h;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    HistoryManager(const HistoryManager&) = delete;
+    HistoryManager& operator=(const HistoryManager&) = delete;
+
+    void init(const QString& historyDir);
+
+    void recordRevision(const QString& uuid, const CodeNote& codeNote);
+    QVector<RevisionInfo> revisions(const QString& uuid) const;
+    CodeNote restoreRevision(const QString& uuid, int index, bool *ok = nullptr) const;
+    void flush();
+    bool collectBlobReferences(QSet<QString>& paths) const;
+
+    // ======== 差量编码 ========
+    static QByteArray encodeDelta(const QByteArray& base, const QByteArray& target);
+    static QByteArray applyDelta(const QByteArray& base, const QByteArray& delta, bool *ok = nullptr);
+
+signals:
+    void revisionRecorded(const QString& uuid, int index);
+
+private:
+    explicit HistoryManager(QObject *parent = nullptr);
+    ~HistoryManager();
+
+    // 索引记录（定长）
+    struct IndexEntry {
+        qint64 time = 0;        // 毫秒时间戳
+        qint64 offset = 0;      // 数据文件偏移
+        quint32 length = 0;     // 数据长度
+        quint32 size = 0;       // 还原后内容大小
+        quint64 hash = 0;       // 内容哈希，用于跳过未变化的保存
+        quint8 isSnapshot = 0;
+    };
+    static const int INDEX_ENTRY_SIZE = 8 + 8 + 4 + 4 + 8 + 1;
+    static const int SNAPSHOT_INTERVAL = 16;
+
+    void writeRevision(const QString& uuid, const QByteArray& content, const QSet<QString>& blobPaths);
+    bool appendReferences(const QString& uuid, const QSet<QString>& blobPaths);
+    QVector<IndexEntry> readIndex(const QString& uuid) const;
+    QByteArray reconstruct(const QString& uuid, const QVector<IndexEntry>& entries, int index, bool *ok) const;
+    QString dataPath(const QString& uuid) const;
+    QString indexPath(const QString& uuid) const;
+    QString refsPath(const QString& uuid) const;
+    static quint64 contentHash(const QByteArray& content);
+
+    QString m_historyDir;
+    QThreadPool m_pool;         // 单线程，保证同一笔记的版本顺序
+    mutable QMutex m_mutex;     // 保护文件读写
+    QString m_lastUuid;         // 最近记录的笔记及其内容，连续保存时无需重建上一版本
+    QByteArray m_lastContent;
+};
+
+#endif // HISTORYMANAGER_H
@@ -0,0 +1,80 @@
+#include "imageingestor.h"
+#include "blobstore.h"
+#include "thumbnailcache.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QtConcurrent>
+
+ImageIngestor::ImageIngestor(QObject *parent) : QObject(parent)
+{
+    // 入库以磁盘写入为主，两个线程足够，避免与缩略图生成争抢
+    m_pool.setMaxThreadCount(2);
+}
+
+ImageIngestor::~ImageIngestor()
+{
+    m_pool.waitForDone();
+}
+
+// 编码设置在提交时确定，工作线程只使用副本
+QFuture<IngestResult> ImageIngestor::ingestImage(const QImage &image, const QSize &previewSize)
+{
+    QByteArray format = "PNG";
+    // PNG的quality对应压缩级别：100为不压缩，0为最高压缩
+    int quality = 100 - (m_pngCompression * 91 + 8) / 9;
+    if(m_format == "webp" && isWebpSupported())
+    {
+        format = "WEBP";
+        quality = 100; // WebP插件在quality为100时使用无损编码
+    }
+
+    return QtConcurrent::run(&m_pool, [=](){
+        IngestResult result;
+        result.blobPath = BlobStore::getBlobStore()->ingestImage(image, format.constData(), quality);
+        if(!result.blobPath.isEmpty()) result.preview = decodePreview(result.blobPath, previewSize);
+        return result;
+    });
+}
+
+QFuture<IngestResult> ImageIngestor::ingestFile(const QString &filePath, const QSize &previewSize)
+{
+    return QtConcurrent::run(&m_pool, [=](){
+        IngestResult result;
+        // 只校验文件头，不解码
+        QImageReader reader(filePath);
+        if(!reader.canRead())
+        {
+            qWarning() << "Not a readable image" << filePath << reader.errorString();
+            return result;
+        }
+
+        result.blobPath = BlobStore::getBlobStore()->ingestFile(filePath);
+        if(!result.blobPath.isEmpty()) result.preview = decodePreview(result.blobPath, previewSize);
+        return result;
+    });
+}
+
+void ImageIngestor::setEncoding(const QString &format, int pngCompression)
+{
+    m_format = format.toLower();
+    m_pngCompression = qBound(0, pngCompression, 9);
+    if(m_format == "webp" && !isWebpSupported())
+    {
+        qWarning() << "WebP image plugin is not available, images are stored as PNG";
+    }
+}
+
+bool ImageIngestor::isWebpSupported()
+{
+    return QImageWriter::supportedImageFormats().contains("webp");
+}
+
+// GIF由单元格按动画处理，不生成预览
+QImage ImageIngestor::decodePreview(const QString &blobPath, const QSize &previewSize)
+{
+    if(previewSize.isEmpty() || QFileInfo(blobPath).suffix().toLower() == "gif") return QImage();
+    return ThumbnailCache::decodeScaled(blobPath, previewSize);
+}
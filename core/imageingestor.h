@@ -0,0 +1,70 @@
+#ifndef IMAGEINGESTOR_H
+#define IMAGEINGESTOR_H
+/*****************************************************
+*
+* @file     imageingestor.h
+* @brief    图片入库类（单例），在工作线程中完成编码、哈希、存入BlobStore和生成预览
+*
+* @description
+*           ==== 核心功能 ====
+*           - ingestImage()：粘贴/拖入的图片数据按设置的格式编码后入库
+*           - ingestFile()：选择/拖入的图片文件校验后哈希并复制入库
+*           - 入库后按请求的尺寸解码预览图，调用方可直接显示，无需再次解码
+*           - 编码设置：PNG（压缩级别0~9）或无损WebP（需要WebP图片插件，不可用时回退为PNG）
+*           ==== 使用说明 ====
+*           1. 调用ingestImage()/ingestFile()得到QFuture，通过QFutureWatcher等待结果
+*           2. 结果不再需要时（单元格销毁、被新的入库替换）直接丢弃，未被保存的图片由BlobStore回收
+*           3. 设置变化时调用setEncoding()，只影响之后提交的任务
+*           ==== 注意 ====
+*           入库失败时blobPath为空；预览图可能为空（GIF或未请求预览）
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QFuture>
+#include <QImage>
+#include <QObject>
+#include <QThreadPool>
+
+struct IngestResult {
+    QString blobPath;   // 存储路径，失败为空
+    QImage preview;     // 按请求尺寸解码的预览图
+};
+
+class ImageIngestor : public QObject
+{
+    Q_OBJECT
+public:
+    // 单例模式
+    static ImageIngestor *getImageIngestor()
+    {
+        static ImageIngestor i;
+        return &i;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    ImageIngestor(const ImageIngestor&) = delete;
+    ImageIngestor& operator=(const ImageIngestor&) = delete;
+
+    QFuture<IngestResult> ingestImage(const QImage& image, const QSize& previewSize = QSize());
+    QFuture<IngestResult> ingestFile(const QString& filePath, const QSize& previewSize = QSize());
+
+    // 编码设置：format为"png"或"webp"，pngCompression为0~9
+    void setEncoding(const QString& format, int pngCompression);
+    QString format() const { return m_format; }
+    int pngCompression() const { return m_pngCompression; }
+    static bool isWebpSupported();
+
+private:
+    explicit ImageIngestor(QObject *parent = nullptr);
+    ~ImageIngestor();
+
+    static QImage decodePreview(const QString& blobPath, const QSize& previewSize);
+
+    QString m_format = "png";
+    int m_pngCompression = 6;
+    QThreadPool m_pool;
+};
+
+#endif // IMAGEINGESTOR_H
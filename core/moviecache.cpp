@@ -0,0 +1,96 @@
+#include "moviecache.h"
+#include "thumbnailcache.h"
+
+#include <QDebug>
+#include <QMovie>
+
+SharedMovie::SharedMovie(const QString &fileName, QObject *parent)
+    : QObject(parent), m_fileName(fileName)
+{
+    m_movie = new QMovie(fileName, QByteArray(), this);
+    // 缩放后的帧存入ThumbnailCache，不再保留全尺寸的帧
+    m_movie->setCacheMode(QMovie::CacheNone);
+    QObject::connect(m_movie, &QMovie::frameChanged, this, &SharedMovie::frameChanged);
+    // 跳到第一帧以便在播放前显示
+    m_movie->jumpToFrame(0);
+}
+
+SharedMovie::~SharedMovie()
+{
+    m_movie->stop();
+}
+
+bool SharedMovie::isValid() const
+{
+    return m_movie->isValid();
+}
+
+QSize SharedMovie::frameSize() const
+{
+    QSize size = m_movie->currentPixmap().size();
+    return size.isEmpty() ? m_movie->frameRect().size() : size;
+}
+
+QPixmap SharedMovie::currentPixmap() const
+{
+    return m_movie->currentPixmap();
+}
+
+QPixmap SharedMovie::scaledFrame(const QSize &size)
+{
+    QPixmap frame = m_movie->currentPixmap();
+    if(frame.isNull() || size.isEmpty() || frame.size() == size) return frame;
+
+    int frameNumber = m_movie->currentFrameNumber();
+    if(frameNumber < 0) return frame.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    ThumbnailCache *cache = ThumbnailCache::getThumbnailCache();
+    QString variant = QString("frame%1").arg(frameNumber);
+    QPixmap scaled = cache->cached(m_fileName, size, variant);
+    if(!scaled.isNull()) return scaled;
+
+    scaled = frame.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    cache->insert(m_fileName, size, scaled, variant);
+    return scaled;
+}
+
+void SharedMovie::addViewer()
+{
+    if(++m_viewers != 1) return;
+    if(m_movie->state() == QMovie::Paused) m_movie->setPaused(false);
+    else if(m_movie->state() == QMovie::NotRunning) m_movie->start();
+}
+
+void SharedMovie::removeViewer()
+{
+    if(m_viewers <= 0) return;
+    // 没有观看者时暂停，不再解码和缩放
+    if(--m_viewers == 0 && m_movie->state() == QMovie::Running) m_movie->setPaused(true);
+}
+
+MovieCache::MovieCache(QObject *parent) : QObject(parent)
+{
+}
+
+SharedMovie *MovieCache::acquire(const QString &fileName)
+{
+    if(fileName.isEmpty()) return nullptr;
+
+    SharedMovie *movie = m_movies.value(fileName, nullptr);
+    if(!movie)
+    {
+        movie = new SharedMovie(fileName, this);
+        m_movies.insert(fileName, movie);
+    }
+    movie->m_refCount++;
+    return movie;
+}
+
+void MovieCache::release(SharedMovie *movie)
+{
+    if(!movie || --movie->m_refCount > 0) return;
+
+    m_movies.remove(movie->m_fileName);
+    // 缩放后的帧留在缓存中，重新打开同一动画时仍可命中，由预算淘汰
+    movie->deleteLater();
+}
@@ -0,0 +1,81 @@
+#ifndef MOVIECACHE_H
+#define MOVIECACHE_H
+/*****************************************************
+*
+* @file     moviecache.h
+* @brief    动画缓存类（单例），显示同一GIF的单元格共用一个解码器
+*
+* @description
+*           ==== 核心功能 ====
+*           - 同一文件只创建一个SharedMovie（内部一个QMovie），按引用计数释放
+*           - SharedMovie只在有观看者时播放，最后一个观看者离开（滚出可视区域、标签页隐藏）时暂停
+*           - 缩放后的帧存入ThumbnailCache（以帧号区分），每个目标尺寸的每一帧只缩放一次，
+*             与其他图片共用内存预算
+*           ==== 使用说明 ====
+*           1. acquire(path)取得共享动画，不再使用时release()
+*           2. 可见时addViewer()、不可见时removeViewer()，只在观看期间连接frameChanged()
+*           3. scaledFrame(size)取得当前帧按尺寸缩放后的图片
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QHash>
+#include <QObject>
+#include <QPixmap>
+
+class QMovie;
+class SharedMovie : public QObject
+{
+    Q_OBJECT
+public:
+    QString fileName() const { return m_fileName; }
+    bool isValid() const;
+    QSize frameSize() const;            // 原始帧尺寸
+    QPixmap currentPixmap() const;      // 当前帧原图
+    QPixmap scaledFrame(const QSize& size);
+
+    void addViewer();
+    void removeViewer();
+    int viewerCount() const { return m_viewers; }
+
+signals:
+    void frameChanged();
+
+private:
+    friend class MovieCache;
+    explicit SharedMovie(const QString& fileName, QObject *parent = nullptr);
+    ~SharedMovie();
+
+    QString m_fileName;
+    QMovie *m_movie = nullptr;
+    int m_refCount = 0;
+    int m_viewers = 0;
+};
+
+class MovieCache : public QObject
+{
+    Q_OBJECT
+public:
+    // 单例模式
+    static MovieCache *getMovieCache()
+    {
+        static MovieCache m;
+        return &m;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    MovieCache(const MovieCache&) = delete;
+    MovieCache& operator=(const MovieCache&) = delete;
+
+    SharedMovie *acquire(const QString& fileName);
+    void release(SharedMovie *movie);
+
+private:
+    explicit MovieCache(QObject *parent = nullptr);
+    ~MovieCache() = default;
+
+    QHash<QString, SharedMovie*> m_movies;      // 文件 -> 共享动画
+};
+
+#endif // MOVIECACHE_H
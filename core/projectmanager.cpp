@@ -2,6 +2,7 @@
 
 #include "filemanager.h"
 #include "databasemanager.h"
+#include "savequeue.h"
 #include <QDebug>
 #include <QFileInfo>
 
@@ -31,35 +32,74 @@ ProjectManager::~ProjectManager()
 
 void ProjectManager::cleanupCache()
 {
-    // 如果缓存大小没有超过限制，不需要清理
-    if(m_metaCtks.size() <= m_cacheLimit) return;
-
-    // 计算需要清理的数量
-    int itemsToRemove = m_metaCtks.size() - m_cacheLimit;
-
-    // 按访问时间排序，找到最不常用的项
-    QList<QPair<QDateTime, QString>> sortedItems;
-    for(auto it = m_accessTimes.begin(); it != m_accessTimes.end(); it++)
+    MetaCtkCacheEntry *entry = m_lruTail;
+    while(entry && (m_metaCtks.size() > m_cacheLimit || m_cacheBytes > m_cacheByteBudget))
     {
-        sortedItems.append(qMakePair(it.value(), it.key()));
+        MetaCtkCacheEntry *prev = entry->prev;
+        // 被打开的笔记固定的项跳过
+        if(entry->pins == 0)
+        {
+            removeEntry(entry);
+            m_cacheStats.evictions++;
+        }
+        entry = prev;
     }
+}
 
-    // 按访问时间升序排序（最早的在前）
-    std::sort(sortedItems.begin(), sortedItems.end(),
-              [](const QPair<QDateTime, QString> &a, const QPair<QDateTime, QString> &b) {
-        return a.first < b.first;
-    });
+void ProjectManager::unlinkEntry(MetaCtkCacheEntry *entry)
+{
+    if(entry->prev) entry->prev->next = entry->next;
+    else m_lruHead = entry->next;
+    if(entry->next) entry->next->prev = entry->prev;
+    else m_lruTail = entry->prev;
+    entry->prev = entry->next = nullptr;
+}
 
-    // 移除最不常用的项
-    for(int i = 0; i < itemsToRemove && i < sortedItems.size(); i++)
+void ProjectManager::linkFront(MetaCtkCacheEntry *entry)
+{
+    entry->prev = nullptr;
+    entry->next = m_lruHead;
+    if(m_lruHead) m_lruHead->prev = entry;
+    m_lruHead = entry;
+    if(!m_lruTail) m_lruTail = entry;
+}
+
+// 正文是延迟读取的，每次访问时重新估算
+void ProjectManager::updateEntrySize(MetaCtkCacheEntry *entry)
+{
+    qint64 bytes = entry->metaCtk->estimatedSize();
+    m_cacheBytes += bytes - entry->bytes;
+    entry->bytes = bytes;
+}
+
+// 移出缓存；仍被句柄固定时延迟到最后一个句柄释放再删除
+void ProjectManager::removeEntry(MetaCtkCacheEntry *entry)
+{
+    unlinkEntry(entry);
+    m_metaCtks.remove(entry->key);
+    m_cacheBytes -= entry->bytes;
+    if(entry->pins > 0)
     {
-        releaseMetaCtk(sortedItems[i].second);
+        entry->detached = true;
+        m_pinnedCount--;
+        return;
     }
+    delete entry->metaCtk;
+    delete entry;
 }
 
-void ProjectManager::updateAccessTime(const QString &configPath)
+void ProjectManager::unpin(MetaCtkCacheEntry *entry)
 {
-    m_accessTimes[configPath] = QDateTime::currentDateTime();
+    if(--entry->pins > 0) return;
+    if(entry->detached)
+    {
+        delete entry->metaCtk;
+        delete entry;
+        return;
+    }
+    m_pinnedCount--;
+    updateEntrySize(entry);
+    cleanupCache();
 }
 
 void ProjectManager::handleConnect()
@@ -84,39 +124,71 @@ void ProjectManager::handleConnect()
         }
         delete metaCtk;
     });
+    // 后台保存完成后更新写入者的文件状态，避免下次load()重复读取自己写入的内容；
+    // 同一文件的其他实例（另一个缓存键、临时对象）的数据可能已过时，保持原状态以便重新读取
+    QObject::connect(SaveQueue::getSaveQueue(), &SaveQueue::saveFinished, this,
+                     [=](const QString &configPath, bool success, quint64 ticket){
+        if(!success || SaveQueue::getSaveQueue()->isPending(configPath)) return;
+        for(MetaCtkCacheEntry *entry : m_metaCtks)
+        {
+            if(entry->metaCtk->saveTicket() != ticket) continue;
+            if(entry->metaCtk->configPath() == configPath) entry->metaCtk->refreshFileStamp();
+            break;
+        }
+    });
 }
 
 MetaCtk *ProjectManager::getMetaCtk(const QString& configPath)
 {
-    if(configPath.isEmpty()) return nullptr;
-    // 如果已经缓存，直接返回
-    if(m_metaCtks.contains(configPath))
-    {
-        updateAccessTime(configPath);
-        return m_metaCtks[configPath];
-    }
+    MetaCtkCacheEntry *entry = lookupEntry(configPath);
+    return entry ? entry->metaCtk : nullptr;
+}
 
-    // 检查缓存大小，如果超过限制则清理最不常用的项
-    if(m_metaCtks.size() >= m_cacheLimit)
+MetaCtkHandle ProjectManager::acquireMetaCtk(const QString &configPath)
+{
+    return MetaCtkHandle(lookupEntry(configPath));
+}
+
+MetaCtkCacheEntry *ProjectManager::lookupEntry(const QString &configPath)
+{
+    if(configPath.isEmpty()) return nullptr;
+    // 如果已经缓存，移到表头后直接返回
+    MetaCtkCacheEntry *entry = m_metaCtks.value(configPath);
+    if(entry)
     {
-        cleanupCache();
+        m_cacheStats.hits++;
+        unlinkEntry(entry);
+        linkFront(entry);
+        updateEntrySize(entry);
+        return entry;
     }
 
     // 创建新实例并缓存
-    MetaCtk* metaCtk = new MetaCtk(configPath);
-    m_metaCtks[configPath] = metaCtk;
-    updateAccessTime(configPath);
-
-    return metaCtk;
+    m_cacheStats.misses++;
+    entry = new MetaCtkCacheEntry;
+    entry->key = configPath;
+    entry->metaCtk = new MetaCtk(configPath);
+    m_metaCtks.insert(configPath, entry);
+    linkFront(entry);
+    updateEntrySize(entry);
+
+    // 超过限制时清理最久未使用的项（新项在表头，不会被清理）
+    cleanupCache();
+    return entry;
 }
 
 void ProjectManager::releaseMetaCtk(const QString &configPath)
 {
-    if(m_metaCtks.contains(configPath))
+    MetaCtkCacheEntry *entry = m_metaCtks.value(configPath);
+    if(entry) removeEntry(entry);
+}
+
+// 迁移格式时调用，否则打开的笔记再次保存时会写回旧格式
+void ProjectManager::setCachedFormat(MetaCtk::StorageFormat format)
+{
+    for(MetaCtkCacheEntry *entry : m_metaCtks)
     {
-        delete m_metaCtks[configPath];
-        m_metaCtks.remove(configPath);
-        m_accessTimes.remove(configPath);
+        entry->metaCtk->setFormat(format);
     }
 }
 
@@ -290,8 +362,64 @@ void ProjectManager::clearCache(const QString &configPath)
 
 void ProjectManager::clearAllCache()
 {
-    for(const QString& key : m_metaCtks.keys())
-    {
-        releaseMetaCtk(key);
-    }
+    while(m_lruHead) removeEntry(m_lruHead);
+}
+
+void ProjectManager::setCacheLimit(int limit)
+{
+    m_cacheLimit = limit;
+    cleanupCache();
+}
+
+void ProjectManager::setCacheByteBudget(qint64 bytes)
+{
+    m_cacheByteBudget = bytes;
+    cleanupCache();
+}
+
+MetaCtkCacheStats ProjectManager::cacheStats() const
+{
+    MetaCtkCacheStats stats = m_cacheStats;
+    stats.entries = m_metaCtks.size();
+    stats.pinned = m_pinnedCount;
+    stats.bytes = m_cacheBytes;
+    return stats;
+}
+
+void ProjectManager::resetCacheStats()
+{
+    m_cacheStats = MetaCtkCacheStats();
+}
+
+// ======== MetaCtkHandle ========
+MetaCtkHandle::MetaCtkHandle(MetaCtkCacheEntry *entry) : m_entry(entry)
+{
+    if(!m_entry) return;
+    if(m_entry->pins++ == 0) ProjectManager::getProjectManager()->m_pinnedCount++;
+}
+
+MetaCtkHandle::MetaCtkHandle(const MetaCtkHandle &other) : m_entry(other.m_entry)
+{
+    if(m_entry) m_entry->pins++;
+}
+
+MetaCtkHandle &MetaCtkHandle::operator=(const MetaCtkHandle &other)
+{
+    if(m_entry == other.m_entry) return *this;
+    reset();
+    m_entry = other.m_entry;
+    if(m_entry) m_entry->pins++;
+    return *this;
+}
+
+MetaCtkHandle::~MetaCtkHandle()
+{
+    reset();
+}
+
+void MetaCtkHandle::reset()
+{
+    if(!m_entry) return;
+    ProjectManager::getProjectManager()->unpin(m_entry);
+    m_entry = nullptr;
 }
@@ -1,10 +1,60 @@
 #ifndef PROJECTMANAGER_H
 #define PROJECTMANAGER_H
 
+#include <QHash>
 #include <QObject>
 #include "metactk.h"
 #include "sql_table_types.h"
 
+// MetaCtk缓存统计
+struct MetaCtkCacheStats {
+    quint64 hits = 0;       // 命中次数
+    quint64 misses = 0;     // 未命中次数（新建实例）
+    quint64 evictions = 0;  // 淘汰次数
+    int entries = 0;        // 当前缓存项数
+    int pinned = 0;         // 被句柄固定的项数
+    qint64 bytes = 0;       // 估算占用字节数
+
+    double hitRate() const
+    {
+        quint64 total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+};
+
+// 缓存项（侵入式双向链表节点，表头为最近使用）
+struct MetaCtkCacheEntry {
+    QString key;
+    MetaCtk *metaCtk = nullptr;
+    qint64 bytes = 0;
+    int pins = 0;               // 句柄引用数，大于0时不会被淘汰
+    bool detached = false;      // 已移出缓存，最后一个句柄释放时删除
+    MetaCtkCacheEntry *prev = nullptr;
+    MetaCtkCacheEntry *next = nullptr;
+};
+
+// 固定缓存项的引用计数句柄，持有期间MetaCtk不会被删除
+class MetaCtkHandle
+{
+public:
+    MetaCtkHandle() = default;
+    MetaCtkHandle(const MetaCtkHandle& other);
+    MetaCtkHandle& operator=(const MetaCtkHandle& other);
+    ~MetaCtkHandle();
+
+    MetaCtk *get() const { return m_entry ? m_entry->metaCtk : nullptr; }
+    MetaCtk *operator->() const { return get(); }
+    bool isNull() const { return !m_entry; }
+    explicit operator bool() const { return m_entry; }
+    void reset();
+
+private:
+    friend class ProjectManager;
+    explicit MetaCtkHandle(MetaCtkCacheEntry *entry);
+
+    MetaCtkCacheEntry *m_entry = nullptr;
+};
+
 class FileManager;
 class DatabaseManager;
 class ProjectManager : public QObject
@@ -23,8 +73,10 @@ public:
 
     void handleConnect();
     // 通用接口
-    MetaCtk *getMetaCtk(const QString& configPath);
+    MetaCtk *getMetaCtk(const QString& configPath); // 不固定，只应临时使用
+    MetaCtkHandle acquireMetaCtk(const QString& configPath); // 长期持有（如打开的NoteTab）
     void releaseMetaCtk(const QString& configPath);
+    void setCachedFormat(MetaCtk::StorageFormat format); // 已缓存的实例（含打开的笔记）之后按该格式保存
 
     // ======== FileManager ========
     // == 核心操作接口 ==
@@ -65,9 +117,14 @@ public:
     void clearCache(const QString& configPath);
     void clearAllCache();
 
-    // 设置缓存大小限制
-    void setCacheLimit(int limit) { m_cacheLimit = limit; }
+    // 设置缓存大小限制（项数上限和估算字节预算）
+    void setCacheLimit(int limit);
     int cacheLimit() const { return m_cacheLimit; }
+    void setCacheByteBudget(qint64 bytes);
+    qint64 cacheByteBudget() const { return m_cacheByteBudget; }
+
+    MetaCtkCacheStats cacheStats() const;
+    void resetCacheStats();
 
 signals:
     void projectListChanged(); // 项目列表变化信号
@@ -76,15 +133,26 @@ private:
     explicit ProjectManager(QObject *parent = nullptr);
     ~ProjectManager();
 
-    // 清理最不常用的缓存项
-    void cleanupCache();
-
-    // 更新缓存项的访问时间
-    void updateAccessTime(const QString& configPath);
+    friend class MetaCtkHandle;
 
-    QMap<QString, MetaCtk*> m_metaCtks; // 缓存最近使用的MetaCtk实例
-    QMap<QString, QDateTime> m_accessTimes; // 记录每个缓存项的最后访问时间
-    int m_cacheLimit = 20; // 缓存大小限制
+    MetaCtkCacheEntry *lookupEntry(const QString& configPath);
+    // 从表尾淘汰未固定的项，直到满足项数和字节预算
+    void cleanupCache();
+    // 链表操作，均为O(1)
+    void unlinkEntry(MetaCtkCacheEntry *entry);
+    void linkFront(MetaCtkCacheEntry *entry);
+    void updateEntrySize(MetaCtkCacheEntry *entry);
+    void removeEntry(MetaCtkCacheEntry *entry);
+    void unpin(MetaCtkCacheEntry *entry);
+
+    QHash<QString, MetaCtkCacheEntry*> m_metaCtks; // 缓存最近使用的MetaCtk实例
+    MetaCtkCacheEntry *m_lruHead = nullptr;  // 最近使用
+    MetaCtkCacheEntry *m_lruTail = nullptr;  // 最久未使用
+    int m_cacheLimit = 512;                  // 缓存项数上限
+    qint64 m_cacheByteBudget = 64 * 1024 * 1024; // 估算字节预算
+    qint64 m_cacheBytes = 0;
+    int m_pinnedCount = 0;
+    MetaCtkCacheStats m_cacheStats;
 
     int m_rootNodeId = 0;
     FileManager *m_fileManager = nullptr;
@@ -1,7 +1,11 @@
+#include "autosavemanager.h"
 #include "databasemanager.h"
 #include "fontmanager.h"
+#include "imageingestor.h"
+#include "metactk.h"
 #include "settingmanager.h"
 #include "stylemanager.h"
+#include "thumbnailcache.h"
 
 #include <QApplication>
 #include <QDebug>
@@ -60,6 +64,18 @@ void SettingManager::applyCurrentSettings()
     FontManager::getFontManager()->setBaseFont(m_currentSettings.appearance.fontFamily,
                                                m_currentSettings.appearance.fontSize);
 
+    // 应用自动保存设置
+    AutoSaveManager::getAutoSaveManager()->setAutoSave(m_currentSettings.editor.autoSave);
+    AutoSaveManager::getAutoSaveManager()->setSaveOnClose(m_currentSettings.editor.saveOnClose);
+
+    // 应用图片编码设置
+    ImageIngestor::getImageIngestor()->setEncoding(m_currentSettings.editor.imageFormat,
+                                                   m_currentSettings.editor.pngCompression);
+    ThumbnailCache::getThumbnailCache()->setMemoryBudget(m_currentSettings.editor.imageCacheSize * 1024 * 1024);
+
+    // 应用配置文件存储格式（只影响之后新建或迁移的文件）
+    MetaCtk::setDefaultFormat(m_currentSettings.general.storageFormat == "cbor"
+                              ? MetaCtk::StorageFormat::Cbor : MetaCtk::StorageFormat::Json);
 
     emit statusBarVisibilityChanged(m_currentSettings.appearance.showStatusBar);
 }
@@ -161,6 +177,12 @@ void SettingManager::saveAll(const AppSettings &settings)
 {
     m_currentSettings = settings;
 
+    // 自动保存设置无需重启即生效
+    AutoSaveManager::getAutoSaveManager()->setAutoSave(settings.editor.autoSave);
+    AutoSaveManager::getAutoSaveManager()->setSaveOnClose(settings.editor.saveOnClose);
+    ImageIngestor::getImageIngestor()->setEncoding(settings.editor.imageFormat, settings.editor.pngCompression);
+    ThumbnailCache::getThumbnailCache()->setMemoryBudget(settings.editor.imageCacheSize * 1024 * 1024);
+
     // 保存到配置文件
     saveToConfigFile(settings);
     // 保存到数据库
@@ -227,6 +249,9 @@ void SettingManager::loadEditorSettings(EditorSet &settings)
     settings.scrollSpeed = m_settings->value("editor/scrollSpeed", 1).toInt();
     settings.saveOnClose = m_settings->value("editor/saveOnClose", true).toBool();
     settings.autoSave = m_settings->value("editor/autoSave", false).toBool();
+    settings.imageFormat = m_settings->value("editor/imageFormat", "png").toString();
+    settings.pngCompression = m_settings->value("editor/pngCompression", 6).toInt();
+    settings.imageCacheSize = qBound(8, m_settings->value("editor/imageCacheSize", 64).toInt(), 1024);
 }
 
 void SettingManager::loadCodebasicSettings(CodeSet &settings)
@@ -263,7 +288,11 @@ void SettingManager::loadMenuSettings(MenuSet &settings)
 
 void SettingManager::loadExportSettings(ExportSet &settings)
 {
-    Q_UNUSED(settings)
+    // 导出设置
+    settings.format = m_settings->value("export/format", "html").toString();
+    settings.outputDir = m_settings->value("export/outputDir", "").toString();
+    settings.incremental = m_settings->value("export/incremental", true).toBool();
+    settings.threadCount = m_settings->value("export/threadCount", 0).toInt();
 }
 
 void SettingManager::loadGeneralbasicSettings(GeneralSet &settings)
@@ -273,6 +302,7 @@ void SettingManager::loadGeneralbasicSettings(GeneralSet &settings)
     settings.checkForUpdates = m_settings->value("general/checkForUpdates", true).toBool();
     settings.enableLogging = m_settings->value("general/enableLogging", false).toBool();
     settings.logLevel = m_settings->value("general/logLevel", "info").toString();
+    settings.storageFormat = m_settings->value("general/storageFormat", "json").toString();
 }
 
 void SettingManager::loadGeneralShortcutsSettings(GeneralSet &settings)
@@ -314,6 +344,9 @@ void SettingManager::saveEditorSettings(const EditorSet &settings)
     m_settings->setValue("editor/scrollSpeed", settings.scrollSpeed);
     m_settings->setValue("editor/saveOnClose", settings.saveOnClose);
     m_settings->setValue("editor/autoSave", settings.autoSave);
+    m_settings->setValue("editor/imageFormat", settings.imageFormat);
+    m_settings->setValue("editor/pngCompression", settings.pngCompression);
+    m_settings->setValue("editor/imageCacheSize", settings.imageCacheSize);
 
     m_settings->sync();
 }
@@ -364,7 +397,15 @@ void SettingManager::saveMenuSettings(const MenuSet &settings)
 
 void SettingManager::saveExportSettings(const ExportSet &settings)
 {
-    Q_UNUSED(settings)
+    m_currentSettings.exportSet = settings;
+
+    // 基础设置实时保存到配置文件
+    m_settings->setValue("export/format", settings.format);
+    m_settings->setValue("export/outputDir", settings.outputDir);
+    m_settings->setValue("export/incremental", settings.incremental);
+    m_settings->setValue("export/threadCount", settings.threadCount);
+
+    m_settings->sync();
 }
 
 void SettingManager::saveGeneralbasicSettings(const GeneralSet &settings)
@@ -376,6 +417,7 @@ void SettingManager::saveGeneralbasicSettings(const GeneralSet &settings)
     m_settings->setValue("general/checkForUpdates", settings.checkForUpdates);
     m_settings->setValue("general/enableLogging", settings.enableLogging);
     m_settings->setValue("general/logLevel", settings.logLevel);
+    m_settings->setValue("general/storageFormat", settings.storageFormat);
 
     m_settings->sync();
 }
@@ -0,0 +1,213 @@
+#include "thumbnailcache.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QThread>
+
+ThumbnailCache::ThumbnailCache(QObject *parent) : QObject(parent)
+{
+    m_memoryCache.setMaxCost(64 * 1024 * 1024);
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+
+    if(QCoreApplication::instance())
+    {
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [=](){
+            Stats s = stats();
+            qInfo() << "Image cache: hits" << s.hits << "misses" << s.misses
+                    << "resident bytes" << s.residentBytes << "/" << s.budget;
+            clear();
+        });
+    }
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ThumbnailCache::init(const QString &cacheDir)
+{
+    m_cacheDir = QDir(cacheDir).absolutePath();
+    if(!QDir().mkpath(m_cacheDir))
+    {
+        qWarning() << "Failed to create the thumbnail directory" << m_cacheDir;
+        m_cacheDir.clear();
+        return;
+    }
+    qInfo() << "ThumbnailCache initialized" << m_cacheDir;
+}
+
+// 不阻塞：未缓存时返回空图，生成完成后发出thumbnailReady
+QPixmap ThumbnailCache::thumbnail(const QString &imagePath, const QSize &size)
+{
+    if(imagePath.isEmpty() || size.isEmpty()) return QPixmap();
+
+    QString key = memoryKey(imagePath, size);
+    if(QPixmap *pixmap = m_memoryCache.object(key))
+    {
+        m_hits++;
+        return *pixmap;
+    }
+    if(m_pending.contains(key)) return QPixmap();
+
+    m_misses++;
+    m_pending.insert(key);
+    m_pool.start([=](){
+        generate(imagePath, size, key);
+    });
+    return QPixmap();
+}
+
+bool ThumbnailCache::isPending(const QString &imagePath, const QSize &size) const
+{
+    return m_pending.contains(memoryKey(imagePath, size));
+}
+
+void ThumbnailCache::invalidate(const QString &imagePath)
+{
+    QString prefix = imagePath + "|";
+    const QList<QString> keys = m_memoryCache.keys();
+    for(const QString &key : keys)
+    {
+        if(key.startsWith(prefix)) m_memoryCache.remove(key);
+    }
+}
+
+void ThumbnailCache::clear()
+{
+    m_memoryCache.clear();
+}
+
+QPixmap ThumbnailCache::cached(const QString &imagePath, const QSize &size, const QString &variant)
+{
+    if(imagePath.isEmpty() || size.isEmpty()) return QPixmap();
+
+    if(QPixmap *pixmap = m_memoryCache.object(memoryKey(imagePath, size, variant)))
+    {
+        m_hits++;
+        return *pixmap;
+    }
+    m_misses++;
+    return QPixmap();
+}
+
+void ThumbnailCache::insert(const QString &imagePath, const QSize &size, const QPixmap &pixmap, const QString &variant)
+{
+    if(imagePath.isEmpty() || size.isEmpty() || pixmap.isNull()) return;
+    // 超出整个预算的图片QCache不会保存，也不会淘汰其他图片
+    m_memoryCache.insert(memoryKey(imagePath, size, variant), new QPixmap(pixmap), pixmapCost(pixmap));
+}
+
+ThumbnailCache::Stats ThumbnailCache::stats() const
+{
+    Stats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.residentBytes = m_memoryCache.totalCost();
+    s.budget = m_memoryCache.maxCost();
+    s.entries = m_memoryCache.count();
+    return s;
+}
+
+QImage ThumbnailCache::decodeScaled(const QString &imagePath, const QSize &size)
+{
+    QImageReader reader(imagePath);
+    reader.setAutoTransform(true);
+    QSize sourceSize = reader.size();
+    if(sourceSize.isValid())
+    {
+        QSize scaledSize = sourceSize.scaled(size, Qt::KeepAspectRatio);
+        // 只缩小不放大；支持的格式（如JPEG）解码时即按比例缩小
+        if(scaledSize.width() < sourceSize.width()) reader.setScaledSize(scaledSize.expandedTo(QSize(1, 1)));
+    }
+
+    QImage image = reader.read();
+    if(image.isNull())
+    {
+        qWarning() << "Failed to load thumbnail:" << imagePath << reader.errorString();
+        return QImage();
+    }
+    // 不支持按尺寸解码的格式在此缩放
+    if(image.width() > size.width() || image.height() > size.height())
+    {
+        image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+// 包含修改时间和文件大小，原图被替换后不会命中旧图片；以路径开头，invalidate()按前缀删除
+QString ThumbnailCache::memoryKey(const QString &imagePath, const QSize &size, const QString &variant)
+{
+    QFileInfo info(imagePath);
+    QString key = QString("%1|%2|%3|%4x%5")
+            .arg(imagePath)
+            .arg(info.lastModified().toMSecsSinceEpoch())
+            .arg(info.size())
+            .arg(size.width()).arg(size.height());
+    if(!variant.isEmpty()) key += "|" + variant;
+    return key;
+}
+
+int ThumbnailCache::pixmapCost(const QPixmap &pixmap)
+{
+    return qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8);
+}
+
+// 磁盘缓存键包含修改时间和文件大小，原图变化后不会命中旧缩略图
+QString ThumbnailCache::diskPath(const QString &imagePath, const QSize &size) const
+{
+    if(m_cacheDir.isEmpty()) return QString();
+    QFileInfo info(imagePath);
+    QByteArray key = QString("%1|%2|%3|%4x%5")
+            .arg(info.absoluteFilePath())
+            .arg(info.lastModified().toMSecsSinceEpoch())
+            .arg(info.size())
+            .arg(size.width()).arg(size.height()).toUtf8();
+    return m_cacheDir + "/" + QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex() + ".png";
+}
+
+// 工作线程：先读磁盘缓存，没有则解码原图并写入缓存
+void ThumbnailCache::generate(const QString &imagePath, const QSize &size, const QString &key)
+{
+    QImage image;
+    if(QFileInfo::exists(imagePath))
+    {
+        QString cachePath = diskPath(imagePath, size);
+        if(!cachePath.isEmpty() && QFileInfo::exists(cachePath)) image.load(cachePath, "PNG");
+
+        if(image.isNull())
+        {
+            image = decodeScaled(imagePath, size);
+            if(!image.isNull() && !cachePath.isEmpty())
+            {
+                QSaveFile file(cachePath);
+                if(!file.open(QIODevice::WriteOnly) || !image.save(&file, "PNG") || !file.commit())
+                {
+                    qWarning() << "Failed to write thumbnail cache" << cachePath;
+                }
+            }
+        }
+    }
+    else qWarning() << "The image does not exist: " << imagePath;
+
+    QMetaObject::invokeMethod(this, [=](){
+        deliver(imagePath, size, key, image);
+    }, Qt::QueuedConnection);
+}
+
+// 主线程：QPixmap只能在GUI线程创建
+void ThumbnailCache::deliver(const QString &imagePath, const QSize &size, const QString &key, const QImage &image)
+{
+    m_pending.remove(key);
+    QPixmap *pixmap = new QPixmap(QPixmap::fromImage(image));
+    m_memoryCache.insert(key, pixmap, pixmapCost(*pixmap));
+    emit thumbnailReady(imagePath, size);
+}
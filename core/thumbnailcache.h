@@ -0,0 +1,99 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+/*****************************************************
+*
+* @file     thumbnailcache.h
+* @brief    缩略图缓存类（单例），也是全进程共享的已解码图片缓存
+*
+* @description
+*           ==== 核心功能 ====
+*           - 在后台线程用QImageReader::setScaledSize按目标尺寸解码，不解码全分辨率图片
+*           - 磁盘缓存：<cacheDir>/<键哈希>.png，键由图片路径、修改时间、文件大小和目标尺寸组成，
+*             原图变化后自动失效
+*           - 内存缓存：键同样包含路径、修改时间、文件大小和尺寸，所有控件共用一个字节预算，
+*             超出预算时淘汰最久未使用的；统计命中、未命中次数和常驻字节数
+*           ==== 使用说明 ====
+*           1. 启动时调用init()设置磁盘缓存目录
+*           2. thumbnail()立即返回：已缓存时返回缩略图，否则返回空图并在后台生成，
+*              生成后发出thumbnailReady()，调用方在此之前显示占位图标（首页、目录树）
+*           3. 自行解码的控件（图片单元格、ImageLabel、GIF帧）先用cached()查找，解码后用insert()存入；
+*              variant区分同一图片同一尺寸的不同内容（如GIF的帧号）
+*           4. stats()取得统计，程序退出时输出到日志
+*           ==== 注意 ====
+*           同一路径和尺寸的请求在生成完成前只提交一次；生成失败的也会缓存（空图），不再重复尝试
+*           程序退出前清空内存缓存，QPixmap必须在QApplication析构前释放
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QCache>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QThreadPool>
+
+class QImage;
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        int residentBytes = 0;
+        int budget = 0;
+        int entries = 0;
+    };
+
+    // 单例模式
+    static ThumbnailCache *getThumbnailCache()
+    {
+        static ThumbnailCache t;
+        return &t;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    void init(const QString& cacheDir);
+
+    QPixmap thumbnail(const QString& imagePath, const QSize& size);
+    bool isPending(const QString& imagePath, const QSize& size) const;
+    void invalidate(const QString& imagePath);
+    void clear();
+
+    // 同步查找/存入，供自行解码的控件使用
+    QPixmap cached(const QString& imagePath, const QSize& size, const QString& variant = QString());
+    void insert(const QString& imagePath, const QSize& size, const QPixmap& pixmap, const QString& variant = QString());
+
+    void setMemoryBudget(int bytes) { m_memoryCache.setMaxCost(bytes); }
+    int memoryBudget() const { return m_memoryCache.maxCost(); }
+    Stats stats() const;
+
+    // 按目标尺寸解码（可在任意线程调用）
+    static QImage decodeScaled(const QString& imagePath, const QSize& size);
+
+signals:
+    void thumbnailReady(const QString& imagePath, const QSize& size);
+
+private:
+    explicit ThumbnailCache(QObject *parent = nullptr);
+    ~ThumbnailCache();
+
+    static QString memoryKey(const QString& imagePath, const QSize& size, const QString& variant = QString());
+    static int pixmapCost(const QPixmap& pixmap);
+    QString diskPath(const QString& imagePath, const QSize& size) const;
+    void generate(const QString& imagePath, const QSize& size, const QString& key);
+    void deliver(const QString& imagePath, const QSize& size, const QString& key, const QImage& image);
+
+    QString m_cacheDir;
+    QCache<QString, QPixmap> m_memoryCache;  // 键 -> 已解码图片，按字节计费
+    QSet<QString> m_pending;                 // 正在生成的键
+    qint64 m_hits = 0;
+    qint64 m_misses = 0;
+    QThreadPool m_pool;
+};
+
+#endif // THUMBNAILCACHE_H
@@ -1,15 +1,10 @@
 #include "codeeditor.h"
-#include "languagespecfactory.h"
+#include "languageregistry.h"
 
-//以C++语法作为例子，该语法分析器的头文件
-#include <Qsci/qscilexercpp.h>
-#include <Qsci/qscilexerpython.h>
-#include <Qsci/qscilexerjava.h>
-#include <Qsci/qscilexerjavascript.h>
-//设置代码提示功能，依靠QsciAPIs类实现
-#include <Qsci/qsciapis.h>
+#include <Qsci/qscilexer.h>
 
 #include <QDebug>
+#include <QFile>
 #include <QKeyEvent>
 
 CodeEditor::CodeEditor(QWidget *parent) : QsciScintilla(parent)
@@ -25,23 +20,21 @@ CodeEditor::CodeEditor(QWidget *parent) : QsciScintilla(parent)
     });
 }
 
-CodeEditor::~CodeEditor()
-{
-    if(m_languageSpec)
-    {
-        delete m_languageSpec;
-        m_languageSpec = nullptr;
-    }
-}
-
 void CodeEditor::setConfig(const EditorConfig &config)
 {
     m_config = config;
-    setupLexer(config.language);
+    // 大内容模式不设置词法分析器，不对全文着色
+    if(m_largeContentMode)
+    {
+        setLexer(nullptr);
+        m_lexer = nullptr;
+    }
+    else setupLexer(config.language);
 
     // ==== 应用通用设置 ====
     setUtf8(true);
-    setFolding(config.codeFolding ? QsciScintilla::BoxedTreeFoldStyle : QsciScintilla::NoFoldStyle);
+    bool folding = config.codeFolding && !m_largeContentMode;
+    setFolding(folding ? QsciScintilla::BoxedTreeFoldStyle : QsciScintilla::NoFoldStyle);
 
     // ==== 设置边线 ====
     // EdgeLine: 在指定列显示竖线，帮助控制代码宽度
@@ -51,7 +44,7 @@ void CodeEditor::setConfig(const EditorConfig &config)
 
     // ==== 设置括号匹配 ====
     // SloppyBraceMatch: 宽松的括号匹配，即使不在同一行也能匹配
-    setBraceMatching(QsciScintilla::SloppyBraceMatch);
+    setBraceMatching(m_largeContentMode ? QsciScintilla::NoBraceMatch : QsciScintilla::SloppyBraceMatch);
     setMatchedBraceBackgroundColor(QColor(180, 238, 180));  // 匹配括号背景色
     setMatchedBraceForegroundColor(Qt::red);                // 匹配括号前景色
 
@@ -75,7 +68,7 @@ void CodeEditor::setConfig(const EditorConfig &config)
     setupMargins(config);
 
     // ==== 代码提示 ====
-    if(config.autoCompletion)
+    if(config.autoCompletion && !m_largeContentMode)
     {
         // AcsAll: 从所有文档内容中获取补全建议
         setAutoCompletionSource(QsciScintilla::AcsAll);
@@ -114,6 +107,71 @@ EditorConfig CodeEditor::getConfig() const
     return m_config;
 }
 
+void CodeEditor::setLargeContentMode(bool enabled)
+{
+    if(m_largeContentMode == enabled) return;
+    m_largeContentMode = enabled;
+    // 只缓存可见页的排版，长文档不为每行保留排版结果
+    SendScintilla(SCI_SETLAYOUTCACHE, enabled ? SC_CACHE_PAGE : SC_CACHE_CARET);
+    setConfig(m_config);
+}
+
+bool CodeEditor::isLargeContentMode() const
+{
+    return m_largeContentMode;
+}
+
+// 映射文件后分块追加到编辑器，文件内容不转换为QString
+bool CodeEditor::loadFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Failed to open the file" << filePath << file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    const qint64 chunkSize = 4 * 1024 * 1024;
+    bool readOnly = isReadOnly();
+    setReadOnly(false);
+    SendScintilla(SCI_CLEARALL);
+    SendScintilla(SCI_ALLOCATE, static_cast<unsigned long>(size + 1));
+
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    if(mapped)
+    {
+        for(qint64 offset = 0; offset < size; offset += chunkSize)
+        {
+            SendScintilla(SCI_APPENDTEXT, static_cast<unsigned long>(qMin(size - offset, chunkSize)),
+                          reinterpret_cast<const char *>(mapped + offset));
+        }
+        file.unmap(mapped);
+    }
+    else
+    {
+        // 不支持映射时按块读取
+        while(!file.atEnd())
+        {
+            QByteArray chunk = file.read(chunkSize);
+            if(chunk.isEmpty()) break;
+            SendScintilla(SCI_APPENDTEXT, static_cast<unsigned long>(chunk.size()), chunk.constData());
+        }
+    }
+
+    SendScintilla(SCI_EMPTYUNDOBUFFER);
+    SendScintilla(SCI_SETSAVEPOINT);
+    setReadOnly(readOnly);
+    return true;
+}
+
+// 编辑器内部缓冲区（移动间隙后连续），在下一次修改前有效
+const char *CodeEditor::bufferData(qint64 *length)
+{
+    if(length) *length = SendScintilla(SCI_GETLENGTH);
+    return static_cast<const char *>(SendScintillaPtrResult(SCI_GETCHARACTERPOINTER));
+}
+
 void CodeEditor::toggleBreakpoint(int line)
 {
     if(markersAtLine(line) & (1 << BREAKPOINT_MARKER_NUM)) markerDelete(line, BREAKPOINT_MARKER_NUM);
@@ -321,41 +379,13 @@ void CodeEditor::setupMargins(const EditorConfig &config)
     setMarginWidth(4, 0);
 }
 
+// 词法分析器和API补全由LanguageRegistry按语言共享，不再为每个编辑器创建和准备
 void CodeEditor::setupLexer(const Language &language)
 {
-    setLexer(nullptr);
-    m_lexer = nullptr;
-
-    if(m_languageSpec)
-    {
-        delete m_languageSpec;
-        m_languageSpec = nullptr;
-    }
-
-    // 创建新的语言规范
-    m_languageSpec = LanguageSpecFactory::createSpec(language);
-    if (!m_languageSpec) return;
-
-    // 创建词法分析器
-    QsciLexer *newLexer = m_languageSpec->createLexer();
-    if(!newLexer) return;
-
-    // 应用字体和语法高亮
-    newLexer->setFont(m_config.font);
-    m_languageSpec->applySyntaxHighlighting(newLexer, m_config.syntaxHighlighting);
-
-    setLexer(newLexer);
-    m_lexer = newLexer;
-
-    setupAPIs();
-}
-
-void CodeEditor::setupAPIs()
-{
-    if(!m_lexer || !m_languageSpec) return;
+    QsciLexer *sharedLexer = LanguageRegistry::getLanguageRegistry()->lexer(language, m_config.font,
+                                                                           m_config.syntaxHighlighting);
+    if(sharedLexer == m_lexer && lexer() == sharedLexer) return;
 
-    QsciAPIs *apis = new QsciAPIs(m_lexer);
-    m_languageSpec->setupAPIs(apis);
-    apis->prepare();
-    m_lexer->setAPIs(apis);
+    setLexer(sharedLexer);
+    m_lexer = sharedLexer;
 }
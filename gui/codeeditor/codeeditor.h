@@ -5,13 +5,11 @@
 #include <Qsci/qsciscintilla.h>
 #include <editor_config.h>
 
-class LanguageSpec;
 class CodeEditor : public QsciScintilla
 {
     Q_OBJECT
 public:
     explicit CodeEditor(QWidget *parent = nullptr);
-    ~CodeEditor();
 
     // 设置编辑器配置
     void setConfig(const EditorConfig &config);
@@ -23,6 +21,13 @@ public:
     // 获取当前配置
     EditorConfig getConfig() const;
 
+    // 大内容模式：关闭词法分析、自动补全、括号匹配和折叠
+    void setLargeContentMode(bool enabled);
+    bool isLargeContentMode() const;
+    // 不经过QString：从文件映射直接载入，或直接访问编辑器内部缓冲区（UTF-8）
+    bool loadFile(const QString &filePath);
+    const char *bufferData(qint64 *length);
+
     // 断点和书签
     void toggleBreakpoint(int line);
     // 预设配置
@@ -45,15 +50,14 @@ protected:
 private:
     void setupMargins(const EditorConfig &config);
     void setupLexer(const Language &language);
-    void setupAPIs();
 
     // 自动括号补全
     void autoCompleteBracket(QKeyEvent *event);
     void smartNewlineInBrackets(QKeyEvent *event);
 
     EditorConfig m_config;
-    QsciLexer *m_lexer = nullptr;
-    LanguageSpec* m_languageSpec = nullptr;
+    QsciLexer *m_lexer = nullptr; // LanguageRegistry共享，不归编辑器所有
+    bool m_largeContentMode = false;
 
     // 断点标记编号
     static const int BREAKPOINT_MARKER_NUM = 10;
@@ -0,0 +1,104 @@
+#include "codeeditorpool.h"
+#include "codeeditor.h"
+#include "stylemanager.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QTimer>
+#include <Qsci/qscidocument.h>
+
+CodeEditorPool::CodeEditorPool(QObject *parent) : QObject(parent)
+{
+    m_warmUpTimer = new QTimer(this);
+    m_warmUpTimer->setSingleShot(true);
+    m_warmUpTimer->setInterval(50); // 每次创建之间让出事件循环
+    QObject::connect(m_warmUpTimer, &QTimer::timeout, this, &CodeEditorPool::warmUpStep);
+
+    // 编辑器是控件，必须在QApplication析构前释放
+    if(QCoreApplication::instance())
+    {
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [=](){
+            m_closed = true;
+            clear();
+        });
+    }
+}
+
+CodeEditorPool::~CodeEditorPool()
+{
+    clear();
+}
+
+CodeEditor *CodeEditorPool::acquire(QWidget *parent)
+{
+    CodeEditor *editor = m_idle.isEmpty() ? createEditor() : m_idle.takeLast();
+    editor->setParent(parent);
+    // 归还时被显式隐藏，加入布局不会自动显示
+    if(parent) editor->show();
+    // 借出后补充，供下一次使用
+    if(!m_closed && m_idle.size() < m_warmCount) warmUp();
+    return editor;
+}
+
+void CodeEditorPool::release(CodeEditor *editor)
+{
+    if(!editor) return;
+    if(m_closed || m_idle.size() >= m_capacity)
+    {
+        editor->hide();
+        editor->setParent(nullptr);
+        // 退出后事件循环已停止，直接删除
+        if(m_closed) delete editor;
+        else editor->deleteLater();
+        return;
+    }
+
+    reset(editor);
+    m_idle.append(editor);
+}
+
+void CodeEditorPool::warmUp()
+{
+    if(!m_warmUpTimer->isActive()) m_warmUpTimer->start();
+}
+
+void CodeEditorPool::clear()
+{
+    m_warmUpTimer->stop();
+    qDeleteAll(m_idle);
+    m_idle.clear();
+    delete m_parking;
+}
+
+CodeEditor *CodeEditorPool::createEditor()
+{
+    CodeEditor *editor = new CodeEditor;
+    // 注册后立即应用当前主题，切换主题时池中的编辑器也会更新
+    StyleManager::getStyleManager()->registerWidget(editor);
+    return editor;
+}
+
+// 换上新的空文档，旧文档（文本、撤销历史、标记）在没有其他引用时释放
+void CodeEditorPool::reset(CodeEditor *editor)
+{
+    if(!m_parking) m_parking = new QWidget;
+
+    editor->hide();
+    editor->setParent(m_parking);
+    editor->setDocument(QsciDocument());
+    editor->setReadOnly(false);
+    editor->setLargeContentMode(false);
+    editor->setMinimumSize(0, 0);
+    editor->setMaximumSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
+    editor->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+void CodeEditorPool::warmUpStep()
+{
+    if(m_idle.size() >= m_warmCount) return;
+
+    CodeEditor *editor = createEditor();
+    reset(editor);
+    m_idle.append(editor);
+    if(m_idle.size() < m_warmCount) m_warmUpTimer->start();
+}
@@ -0,0 +1,73 @@
+#ifndef CODEEDITORPOOL_H
+#define CODEEDITORPOOL_H
+/*****************************************************
+*
+* @file     codeeditorpool.h
+* @brief    代码编辑器池（单例），在单元格和标签页之间复用CodeEditor
+*
+* @description
+*           ==== 核心功能 ====
+*           - 保存一定数量已创建、已应用样式的CodeEditor，CodeItemCell创建时借出，销毁时归还
+*           - 归还时用QsciScintilla::setDocument换上新的空文档（即SCI_SETDOCPOINTER），
+*             旧文档的文本、撤销历史和标记随之释放，不逐字清空
+*           - 空闲时预热：分批创建编辑器直到池中达到预热数量，每批只创建一个，不阻塞界面
+*           ==== 使用说明 ====
+*           1. acquire(parent)借出编辑器，之后由调用方设置语言、内容和尺寸
+*           2. 不再使用时调用release()归还，调用方需先断开自己与编辑器的连接
+*           3. 启动后调用warmUp()在空闲时预热
+*           ==== 注意 ====
+*           超出容量的归还编辑器直接删除；程序退出前统一释放池中的编辑器
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+class CodeEditor;
+class QTimer;
+class QWidget;
+class CodeEditorPool : public QObject
+{
+    Q_OBJECT
+public:
+    // 单例模式
+    static CodeEditorPool *getCodeEditorPool()
+    {
+        static CodeEditorPool p;
+        return &p;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    CodeEditorPool(const CodeEditorPool&) = delete;
+    CodeEditorPool& operator=(const CodeEditorPool&) = delete;
+
+    CodeEditor *acquire(QWidget *parent);
+    void release(CodeEditor *editor);
+
+    void warmUp();
+    void clear();
+
+    void setCapacity(int capacity) { m_capacity = qMax(0, capacity); }
+    int capacity() const { return m_capacity; }
+    int idleCount() const { return m_idle.size(); }
+
+private:
+    explicit CodeEditorPool(QObject *parent = nullptr);
+    ~CodeEditorPool();
+
+    CodeEditor *createEditor();
+    void reset(CodeEditor *editor);
+    void warmUpStep();
+
+    QList<CodeEditor*> m_idle;          // 空闲编辑器，挂在m_parking下
+    QPointer<QWidget> m_parking;        // 不显示的父控件，空闲编辑器不会成为顶层窗口
+    QTimer *m_warmUpTimer = nullptr;
+    int m_capacity = 16;                // 最多保留的空闲编辑器数量
+    int m_warmCount = 4;                // 预热数量
+    bool m_closed = false;              // 程序正在退出，不再回收
+};
+
+#endif // CODEEDITORPOOL_H
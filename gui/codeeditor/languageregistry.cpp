@@ -0,0 +1,100 @@
+#include "languageregistry.h"
+#include "languagespecfactory.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QTimer>
+#include <Qsci/qsciapis.h>
+#include <Qsci/qscilexer.h>
+
+LanguageRegistry::LanguageRegistry(QObject *parent) : QObject(parent)
+{
+    // 程序退出前释放，避免在QApplication析构后销毁字体等资源
+    if(QCoreApplication::instance())
+    {
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                         this, &LanguageRegistry::clear);
+    }
+}
+
+LanguageRegistry::~LanguageRegistry()
+{
+    clear();
+}
+
+// 空闲时逐个创建，避免启动时集中卡顿
+void LanguageRegistry::preload()
+{
+    const QList<Language> languages = LanguageSpecFactory::languages();
+    for(int i = 0; i < languages.size(); i++)
+    {
+        Language language = languages[i];
+        QTimer::singleShot(i * 50, this, [=](){
+            entry(language);
+        });
+    }
+}
+
+QsciLexer *LanguageRegistry::lexer(Language language, const QFont &font, const SyntaxColor &syntax)
+{
+    Entry *e = entry(language);
+    if(!e || !e->lexer) return nullptr;
+
+    // 与上次相同时不重复设置，否则每个编辑器都会触发所有共享编辑器重新着色
+    if(!e->styled || e->font != font || e->syntax != syntax)
+    {
+        e->lexer->setFont(font);
+        e->spec->applySyntaxHighlighting(e->lexer, syntax);
+        e->font = font;
+        e->syntax = syntax;
+        e->styled = true;
+    }
+    return e->lexer;
+}
+
+bool LanguageRegistry::isPrepared(Language language) const
+{
+    auto it = m_entries.constFind(LanguageSpecFactory::canonical(language));
+    return it != m_entries.constEnd() && it->prepared;
+}
+
+void LanguageRegistry::clear()
+{
+    for(auto &e : m_entries)
+    {
+        delete e.lexer; // QsciAPIs是词法分析器的子对象
+        delete e.spec;
+    }
+    m_entries.clear();
+}
+
+LanguageRegistry::Entry *LanguageRegistry::entry(Language language)
+{
+    language = LanguageSpecFactory::canonical(language);
+    auto it = m_entries.find(language);
+    if(it != m_entries.end()) return &it.value();
+
+    Entry e;
+    e.spec = LanguageSpecFactory::createSpec(language);
+    if(!e.spec) return nullptr;
+    e.lexer = e.spec->createLexer();
+    if(!e.lexer)
+    {
+        delete e.spec;
+        return nullptr;
+    }
+
+    e.apis = new QsciAPIs(e.lexer);
+    e.spec->setupAPIs(e.apis);
+    e.lexer->setAPIs(e.apis);
+    it = m_entries.insert(language, e);
+
+    // prepare()在后台线程中执行，完成前补全列表为空
+    QObject::connect(e.apis, &QsciAPIs::apiPreparationFinished, this, [=](){
+        auto found = m_entries.find(language);
+        if(found != m_entries.end()) found->prepared = true;
+    });
+    e.apis->prepare();
+    qInfo() << "Language registered:" << LanguageSpecFactory::languageName(language);
+    return &it.value();
+}
@@ -0,0 +1,71 @@
+#ifndef LANGUAGEREGISTRY_H
+#define LANGUAGEREGISTRY_H
+/*****************************************************
+*
+* @file     languageregistry.h
+* @brief    语言注册表类（单例），所有代码编辑器共享的词法分析器和API补全
+*
+* @description
+*           ==== 核心功能 ====
+*           - 每种语言只创建一个LanguageSpec、一个QsciLexer和一个QsciAPIs，所有CodeEditor共用
+*           - QsciAPIs::prepare()在QScintilla的后台线程中执行，每种语言只准备一次
+*           - 字体和语法颜色只在与上次不同时重新设置（例如切换主题），
+*             共享的词法分析器发出的颜色/字体变化信号会通知所有使用它的编辑器
+*           ==== 使用说明 ====
+*           1. 启动后调用preload()在空闲时预先创建所有语言，也可以不调用，首次使用时创建
+*           2. CodeEditor通过lexer()取得共享的词法分析器
+*           ==== 注意 ====
+*           词法分析器归注册表所有，编辑器不能删除；程序退出前统一释放
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QFont>
+#include <QMap>
+#include <QObject>
+#include <editor_config.h>
+
+class LanguageSpec;
+class QsciLexer;
+class QsciAPIs;
+class LanguageRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    // 单例模式
+    static LanguageRegistry *getLanguageRegistry()
+    {
+        static LanguageRegistry r;
+        return &r;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    LanguageRegistry(const LanguageRegistry&) = delete;
+    LanguageRegistry& operator=(const LanguageRegistry&) = delete;
+
+    void preload();
+    QsciLexer *lexer(Language language, const QFont& font, const SyntaxColor& syntax);
+    bool isPrepared(Language language) const;
+    void clear();
+
+private:
+    explicit LanguageRegistry(QObject *parent = nullptr);
+    ~LanguageRegistry();
+
+    struct Entry {
+        LanguageSpec *spec = nullptr;
+        QsciLexer *lexer = nullptr;
+        QsciAPIs *apis = nullptr;
+        bool prepared = false;
+        bool styled = false;
+        QFont font;
+        SyntaxColor syntax;
+    };
+
+    Entry *entry(Language language);
+
+    QMap<Language, Entry> m_entries;
+};
+
+#endif // LANGUAGEREGISTRY_H
@@ -5,6 +5,33 @@
 #include "pythonlanguagespec.h"
 #include "rustlanguagespec.h"
 
+namespace {
+// 语言信息表，与各LanguageSpec的languageName()/fileExtensions()一致
+struct LanguageInfo {
+    Language language;
+    const char *name;
+    const char *extensions; // 空格分隔
+};
+
+const LanguageInfo LANGUAGE_TABLE[] = {
+    {Language::CPP,        "C++",        "cpp cxx cc c h hpp hxx"},
+    {Language::Python,     "Python",     "py pyw pyx"},
+    {Language::Java,       "Java",       "java"},
+    {Language::JavaScript, "JavaScript", "js mjs cjs"},
+    {Language::Rust,       "Rust",       "rs"},
+};
+
+const LanguageInfo &languageInfo(Language language)
+{
+    Language canonical = LanguageSpecFactory::canonical(language);
+    for(const LanguageInfo &info : LANGUAGE_TABLE)
+    {
+        if(info.language == canonical) return info;
+    }
+    return LANGUAGE_TABLE[0]; // 默认C++
+}
+}
+
 LanguageSpec *LanguageSpecFactory::createSpec(Language language)
 {
     switch(language)
@@ -27,16 +54,34 @@ LanguageSpec *LanguageSpecFactory::createSpec(Language language)
 
 QString LanguageSpecFactory::languageName(Language language)
 {
-    auto spec = createSpec(language);
-    QString name = spec->languageName();
-    delete spec;
-    return name;
+    return QString::fromLatin1(languageInfo(language).name);
 }
 
 QStringList LanguageSpecFactory::fileExtensions(Language language)
 {
-    auto spec = createSpec(language);
-    QStringList extensions = spec->fileExtensions();
-    delete spec;
-    return extensions;
+    return QString::fromLatin1(languageInfo(language).extensions).split(' ', Qt::SkipEmptyParts);
+}
+
+Language LanguageSpecFactory::canonical(Language language)
+{
+    switch(language)
+    {
+    case Language::Python:
+    case Language::Java:
+    case Language::JavaScript:
+    case Language::Rust:
+        return language;
+    default:
+        return Language::CPP; // C及不支持的语言使用C++规范
+    }
+}
+
+QList<Language> LanguageSpecFactory::languages()
+{
+    QList<Language> result;
+    for(const LanguageInfo &info : LANGUAGE_TABLE)
+    {
+        result.append(info.language);
+    }
+    return result;
 }
@@ -8,8 +8,12 @@ class LanguageSpecFactory
 {
 public:
     static LanguageSpec *createSpec(Language language);
+
+    // 语言信息来自静态表，不创建LanguageSpec
     static QString languageName(Language language);
     static QStringList fileExtensions(Language language);
+    static Language canonical(Language language);   // 共用同一规范的语言（如C）映射到同一语言
+    static QList<Language> languages();              // 所有支持的语言
 };
 
 #endif // LANGUAGESPECFACTORY_H
@@ -1,4 +1,5 @@
 #include "imagelabel.h"
+#include "thumbnailcache.h"
 
 #include <QEvent>
 #include <QFile>
@@ -128,15 +129,21 @@ void ImageLabel::updatePixmapFromStyle()
         }
         else
         {
-            // 加载图片
-            if(imageUrl.startsWith(":/")) m_cachedPixmap = QPixmap(imageUrl); // 资源文件
-            else m_cachedPixmap = QPixmap(imageUrl); // 文件路径
-
-            // 缩放图片
-            if(!m_cachedPixmap.isNull() && m_imageSize.isValid())
+            // 相同图标和尺寸的标签共用一份缩放后的图片
+            ThumbnailCache *cache = ThumbnailCache::getThumbnailCache();
+            m_cachedPixmap = cache->cached(imageUrl, m_imageSize);
+            if(m_cachedPixmap.isNull())
             {
-                m_cachedPixmap = m_cachedPixmap.scaled(m_imageSize,
-                                                       Qt::KeepAspectRatio, Qt::SmoothTransformation);
+                // 加载图片（资源文件或文件路径）
+                m_cachedPixmap = QPixmap(imageUrl);
+
+                // 缩放图片
+                if(!m_cachedPixmap.isNull() && m_imageSize.isValid())
+                {
+                    m_cachedPixmap = m_cachedPixmap.scaled(m_imageSize,
+                                                           Qt::KeepAspectRatio, Qt::SmoothTransformation);
+                    cache->insert(imageUrl, m_imageSize, m_cachedPixmap);
+                }
             }
         }
     }
@@ -6,6 +6,15 @@
 #include "sqldatabase.h"
 #include "databasemanager.h"
 #include "stylemanager.h"
+#include "blobstore.h"
+#include "metactk.h"
+#include "exportmanager.h"
+#include "autosavemanager.h"
+#include "historymanager.h"
+#include "savequeue.h"
+#include "thumbnailcache.h"
+#include "languageregistry.h"
+#include "codeeditorpool.h"
 
 #include <QAction>
 #include <QCloseEvent>
@@ -14,6 +23,7 @@
 #include <QDir>
 #include <QPushButton>
 #include <QSplitter>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <settingmanager.h>
 
@@ -43,8 +53,33 @@ MainWidget::MainWidget(QWidget *parent)
     }
     // 初始化数据库
     DatabaseManager::getDatabaseManager()->init(m_rootPath);
+    // 初始化图片存储
+    BlobStore::getBlobStore()->init(QDir(exeDir + "/data/blobs/").absolutePath());
+    // 回收前从已保存的笔记中标记仍被引用的图片
+    QString rootPath = m_rootPath;
+    BlobStore::getBlobStore()->addReferenceScanner([rootPath](QSet<QString> &paths){
+        return MetaCtk::collectBlobReferences(rootPath, paths);
+    });
+    // 初始化导出
+    ExportManager::getExportManager()->init(m_rootPath);
+    // 初始化历史版本存储
+    HistoryManager::getHistoryManager()->init(QDir(exeDir + "/data/history/").absolutePath());
+    // 历史版本引用的图片和外部内容同样不能回收，先等排队中的版本写完
+    BlobStore::getBlobStore()->addReferenceScanner([](QSet<QString> &paths){
+        HistoryManager::getHistoryManager()->flush();
+        return HistoryManager::getHistoryManager()->collectBlobReferences(paths);
+    });
+    // 初始化缩略图缓存
+    ThumbnailCache::getThumbnailCache()->init(QDir(exeDir + "/data/thumbnails/").absolutePath());
+    // 恢复异常退出时未保存的编辑（只检查索引中的日志）
+    AutoSaveManager::getAutoSaveManager()->init(QDir(exeDir + "/data/").absoluteFilePath("journals.json"));
+    AutoSaveManager::getAutoSaveManager()->recoverJournals(m_rootPath);
 
     initUI();
+    // 空闲时预先创建各语言的词法分析器并在后台准备补全列表
+    QTimer::singleShot(0, LanguageRegistry::getLanguageRegistry(), &LanguageRegistry::preload);
+    // 预热代码编辑器池，打开代码笔记时直接复用
+    QTimer::singleShot(0, CodeEditorPool::getCodeEditorPool(), &CodeEditorPool::warmUp);
 
     // 加入日志视图（CTRL+L唤起）
     QAction *action = new QAction("logger", this);
@@ -94,6 +129,13 @@ void MainWidget::showLogViewer()
 
 void MainWidget::closeEvent(QCloseEvent *event)
 {
+    // 保存或询问未保存的笔记，保存失败或取消时不退出
+    if(m_contentTabs && !m_contentTabs->confirmQuit())
+    {
+        event->ignore();
+        return;
+    }
+
     // 关闭所有子窗口
     if(m_logViewer)
     {
@@ -102,6 +144,13 @@ void MainWidget::closeEvent(QCloseEvent *event)
         m_logViewer = nullptr;
     }
 
+    // 保存目录树快照，下次启动直接显示
+    if(m_treePanel) m_treePanel->saveSnapshot();
+
+    // 等待后台保存完成
+    SaveQueue::getSaveQueue()->flush();
+    HistoryManager::getHistoryManager()->flush();
+
     // 接受关闭事件
     event->accept();
 }
@@ -1,17 +1,38 @@
 #include "codeitemcell.h"
-#include "stylemanager.h"
+#include "blobstore.h"
+#include "codeeditorpool.h"
 
 #include <QDebug>
 #include <QFontDatabase>
 #include <QLineEdit>
 #include <QMenu>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 #include <codeeditor.h>
 #include <combobox.h>
 
+namespace {
+// QString按UTF-8编码后的字节数，与编辑器的length()同一单位，不做转换
+qint64 utf8Length(const QString &text)
+{
+    qint64 length = 0;
+    for(const QChar ch : text)
+    {
+        ushort unicode = ch.unicode();
+        if(unicode < 0x80) length += 1;
+        else if(unicode < 0x800 || ch.isSurrogate()) length += 2; // 代理对共4字节
+        else length += 3;
+    }
+    return length;
+}
+}
+
 CodeItemCell::CodeItemCell(NoteItem item, QWidget *parent)
     : ItemCell(item, parent)
 {
+    m_storeWatcher = new QFutureWatcher<QString>(this);
+    QObject::connect(m_storeWatcher, &QFutureWatcher<QString>::finished, this, &CodeItemCell::onContentStored);
+
     initUI();
 
     setContextMenuPolicy(Qt::CustomContextMenu);
@@ -19,6 +40,17 @@ CodeItemCell::CodeItemCell(NoteItem item, QWidget *parent)
                      this, &CodeItemCell::onCustomContextMenu);
 }
 
+CodeItemCell::~CodeItemCell()
+{
+    // 断开本单元格的连接后归还编辑器，编辑器不随单元格删除
+    if(m_codeEditor)
+    {
+        m_codeEditor->disconnect(this);
+        CodeEditorPool::getCodeEditorPool()->release(m_codeEditor);
+        m_codeEditor = nullptr;
+    }
+}
+
 void CodeItemCell::addToolBar(QWidget *button)
 {
     m_codeToolBar->addWidget(button);
@@ -60,18 +92,25 @@ void CodeItemCell::initUI()
     QVBoxLayout *contentVLayout = new QVBoxLayout;
     contentVLayout->setContentsMargins(0, 0, 0, 0);
 
-    // 代码编辑器
-    m_codeEditor = new CodeEditor;
-    StyleManager::getStyleManager()->registerWidget(m_codeEditor);
+    // 代码编辑器（从编辑器池借出，已应用样式）
+    m_codeEditor = CodeEditorPool::getCodeEditorPool()->acquire(this);
     m_codeEditor->setLanguage(Language::CPP);
-    m_codeEditor->setText(m_item.content);
+    updateContent();
     m_codeEditor->setMinimumHeight(300);
 
-    QObject::connect(m_codeEditor, &CodeEditor::textChanged, [=](){
+    QObject::connect(m_codeEditor, &CodeEditor::textChanged, this, [=](){
         if(isUpdateContent) return;
-        m_item.content = m_codeEditor->text();
-        emit contentChanged(m_item);
-        qDebug() << m_codeEditor->getConfig().backgroundColor.name();
+        // 粘贴等操作使内容超过阈值时切换到大内容模式（length()不复制内容）
+        bool large = m_codeEditor->length() >= LARGE_CONTENT_BYTES;
+        if(!m_codeEditor->isLargeContentMode() && large)
+        {
+            m_codeEditor->setLargeContentMode(true);
+        }
+        // 大内容只标记待入库，保存时再写入BlobStore
+        m_contentSerial++;
+        m_contentPending = large;
+        m_storeFailed = false;
+        markDirty();
     });
 
     m_codeToolBar = new QHBoxLayout;
@@ -90,10 +129,119 @@ void CodeItemCell::initUI()
     mainHLayout->addLayout(contentVLayout);
 }
 
+// 大内容不在这里复制或入库（写日志、释放单元格时也会取内容），返回上次入库的路径，
+// 保存时由storePendingContent()在后台入库
+QString CodeItemCell::currentContent() const
+{
+    if(m_codeEditor->length() >= LARGE_CONTENT_BYTES && !m_storeFailed) return m_item.content;
+
+    m_item.external = false;
+    return m_codeEditor->text();
+}
+
+// 待入库的大内容未及时保存时释放单元格会丢失修改
+bool CodeItemCell::isBusy() const
+{
+    return m_contentPending || m_storeWatcher->isRunning();
+}
+
+// 待入库的内容按文本复制，新单元格保存时再入库
+NoteItem CodeItemCell::snapshotItem() const
+{
+    NoteItem result = item();
+    if(!hasPendingContent()) return result;
+    result.content = m_codeEditor->text();
+    result.external = false;
+    return result;
+}
+
+bool CodeItemCell::hasPendingContent() const
+{
+    return m_contentPending && !m_storeFailed;
+}
+
+// 在界面线程复制缓冲区（不经过QString），哈希和写入在工作线程完成
+void CodeItemCell::storePendingContent()
+{
+    if(m_storeWatcher->isRunning()) return; // 完成时会发出contentStored()
+
+    qint64 length = 0;
+    const char *data = m_codeEditor->bufferData(&length);
+    QByteArray content(data, int(length));
+    m_storingContentSerial = m_contentSerial;
+    m_storingItemSerial = m_itemSerial;
+    m_storeWatcher->setFuture(QtConcurrent::run([content](){
+        return BlobStore::getBlobStore()->ingestData(content.constData(), content.size(), "txt");
+    }));
+}
+
+void CodeItemCell::storePendingContentNow()
+{
+    m_itemSerial++;
+    qint64 length = 0;
+    const char *data = m_codeEditor->bufferData(&length);
+    QString path = BlobStore::getBlobStore()->ingestData(data, length, "txt");
+    if(path.isEmpty())
+    {
+        qWarning() << "Failed to store the large code content, keep it inline";
+        m_storeFailed = true;
+    }
+    else
+    {
+        m_item.content = path;
+        m_item.external = true;
+        m_contentPending = false;
+    }
+    markDirty();
+}
+
+void CodeItemCell::onContentStored()
+{
+    QString path = m_storeWatcher->result();
+    // 入库期间重新载入了内容或已立即入库，结果作废
+    if(m_storingItemSerial == m_itemSerial)
+    {
+        if(path.isEmpty())
+        {
+            qWarning() << "Failed to store the large code content, keep it inline";
+            m_storeFailed = true;
+        }
+        else
+        {
+            m_item.content = path;
+            m_item.external = true;
+            // 入库期间又有编辑时仍待入库，下次保存再写入
+            if(m_storingContentSerial == m_contentSerial) m_contentPending = false;
+        }
+        markDirty();
+    }
+    emit contentStored();
+}
+
 void CodeItemCell::updateContent()
 {
     isUpdateContent = true;
-    m_codeEditor->setText(m_item.content);
+    m_itemSerial++;
+    m_storeFailed = false;
+    m_codeEditor->setReadOnly(false);
+    if(m_item.external)
+    {
+        // 外部内容映射后直接载入编辑器，不经过QString
+        m_contentPending = false;
+        m_codeEditor->setLargeContentMode(true);
+        if(!m_codeEditor->loadFile(m_item.content))
+        {
+            m_codeEditor->setText(QString("无法读取外部内容: %1").arg(m_item.content));
+            m_codeEditor->setReadOnly(true); // 防止提示文字被当作内容保存
+        }
+    }
+    else
+    {
+        // 与编辑器的length()同为UTF-8字节；内联的大内容保存时改为外部文件
+        m_contentPending = utf8Length(m_item.content) >= LARGE_CONTENT_BYTES;
+        m_codeEditor->setLargeContentMode(m_contentPending);
+        m_codeEditor->setText(m_item.content);
+    }
     isUpdateContent = false;
 }
 
@@ -101,5 +249,5 @@ void CodeItemCell::updateLanguage(const QString &language)
 {
     m_item.language = language;
     m_codeEditor->setLanguage(language);
-    emit contentChanged(m_item);
+    emit contentChanged();
 }
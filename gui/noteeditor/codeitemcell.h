@@ -3,6 +3,8 @@
 
 #include "itemcell.h"
 
+#include <QFutureWatcher>
+
 class ComboBox;
 class QHBoxLayout;
 class CodeEditor;
@@ -11,25 +13,46 @@ class CodeItemCell : public ItemCell
     Q_OBJECT
 public:
     explicit CodeItemCell(NoteItem item, QWidget *parent = nullptr);
+    ~CodeItemCell();
 
     void addToolBar(QWidget *button);
     void deleteToolBar(QWidget *button);
 
+    bool isBusy() const override;
+    NoteItem snapshotItem() const override;
+    bool hasPendingContent() const override;
+    void storePendingContent() override;
+    void storePendingContentNow() override;
+
 signals:
 
 private slots:
     void updateLanguage(const QString &language);
     void onCustomContextMenu(const QPoint &pos);
+    void onContentStored();
 
 private:
     void initUI() override;
     void updateContent() override;
+    QString currentContent() const override;
 
     QHBoxLayout *m_codeToolBar;
     CodeEditor *m_codeEditor = nullptr;
     ComboBox *m_languageBox = nullptr;
     int m_editorIdealHeight = 0;
 
+    // 超过该大小（UTF-8字节）的内容存为外部文件，编辑器进入大内容模式
+    static const int LARGE_CONTENT_BYTES = 1024 * 1024;
+
+    // ==== 大内容入库（只在保存时进行） ====
+    QFutureWatcher<QString> *m_storeWatcher;
+    bool m_contentPending = false;  // 编辑器中的大内容尚未入库，m_item.content为上次入库的路径
+    bool m_storeFailed = false;     // 入库失败，保存时退回内联文本
+    quint64 m_contentSerial = 0;    // 每次编辑加一
+    quint64 m_itemSerial = 0;       // 载入内容或立即入库时加一，丢弃进行中的后台结果
+    quint64 m_storingContentSerial = 0;
+    quint64 m_storingItemSerial = 0;
+
     bool isUpdateContent = false;
 };
 
@@ -1,5 +1,7 @@
 #include "imageitemcell.h"
 #include "stylemanager.h"
+#include "moviecache.h"
+#include "thumbnailcache.h"
 
 #include <QApplication>
 #include <QClipboard>
@@ -7,13 +9,16 @@
 #include <QDrag>
 #include <QFileDialog>
 #include <QHBoxLayout>
+#include <QImageReader>
 #include <QLabel>
 #include <QMenu>
 #include <QMimeData>
 #include <QMouseEvent>
-#include <QMovie>
 #include <QSettings>
 #include <QStandardPaths>
+#include <QTimer>
+#include <QtConcurrent>
+#include <QDebug>
 
 ImageItemCell::ImageItemCell(NoteItem item, QWidget *parent)
     : ItemCell(item, parent)
@@ -29,12 +34,14 @@ ImageItemCell::ImageItemCell(NoteItem item, QWidget *parent)
 
 ImageItemCell::~ImageItemCell()
 {
-    if(m_movie)
-    {
-        m_movie->stop();
-        delete m_movie;
-        m_movie = nullptr;
-    }
+    releaseMovie();
+}
+
+void ImageItemCell::setOnScreen(bool onScreen)
+{
+    if(m_onScreen == onScreen) return;
+    m_onScreen = onScreen;
+    updatePlayback();
 }
 
 void ImageItemCell::initUI()
@@ -53,22 +60,37 @@ void ImageItemCell::initUI()
 
     mainLayout->addWidget(m_imageLabel);
 
+    m_rescaleTimer = new QTimer(this);
+    m_rescaleTimer->setSingleShot(true);
+    m_rescaleTimer->setInterval(150);
+    QObject::connect(m_rescaleTimer, &QTimer::timeout, this, [=](){
+        if(m_isAnimated) scaleMovieFrame();
+        else requestDecode(displaySize());
+    });
+
+    m_decodeWatcher = new QFutureWatcher<QImage>(this);
+    QObject::connect(m_decodeWatcher, &QFutureWatcher<QImage>::finished, this, &ImageItemCell::onDecodeFinished);
+
+    m_ingestWatcher = new QFutureWatcher<IngestResult>(this);
+    QObject::connect(m_ingestWatcher, &QFutureWatcher<IngestResult>::finished, this, &ImageItemCell::onIngestFinished);
+
     updateContent();
 }
 
 void ImageItemCell::updateContent()
 {
-    // 停止并清理之前的动画
-    if(m_movie)
-    {
-        m_movie->stop();
-        delete m_movie;
-        m_movie = nullptr;
-    }
+    // 释放之前的动画
+    releaseMovie();
+
+    m_displayPixmap = QPixmap();
+    m_sourceSize = QSize();
+    m_decodingSize = QSize();
+    m_pendingDecodeSize = QSize();
+    m_rescaleTimer->stop();
+    m_imageLabel->setPixmap(QPixmap());
 
     if(m_item.content.isEmpty())
     {
-        m_originalPixmaps = QPixmap();
         m_imageLabel->setText("右键添加图片");
         m_isAnimated = false;
     }
@@ -82,18 +104,27 @@ void ImageItemCell::updateContent()
         if(m_isAnimated) setupMovie(m_item.content);
         else
         {
-            QPixmap pixmap;
-            if(pixmap.load(m_item.content))
+            // 只读取文件头获得尺寸，图片在后台按显示尺寸解码
+            QImageReader reader(m_item.content);
+            m_sourceSize = reader.size();
+            if(m_sourceSize.isValid() && !m_ingestPreview.isNull())
             {
-                m_originalPixmaps = pixmap;
-                // 缩放图片以适应标签
+                // 入库时已在后台按标签宽度解码，宽度未变时不再解码
+                m_displayPixmap = QPixmap::fromImage(m_ingestPreview);
+                if(m_ingestPreview.width() == displaySize().width())
+                {
+                    m_decodingSize = displaySize();
+                    ThumbnailCache::getThumbnailCache()->insert(m_item.content, m_decodingSize, m_displayPixmap);
+                }
+                m_ingestPreview = QImage();
                 scaleImages();
             }
-            else
+            else if(m_sourceSize.isValid())
             {
-                m_originalPixmaps = QPixmap();
-                m_imageLabel->setText(QString("无法加载图片: %1").arg(m_item.content));
+                m_imageLabel->setText("加载中...");
+                if(m_imageLabel->width() > 0) requestDecode(displaySize());
             }
+            else m_imageLabel->setText(QString("无法加载图片: %1").arg(m_item.content));
         }
     }
 }
@@ -102,7 +133,27 @@ void ImageItemCell::resizeEvent(QResizeEvent *event)
 {
     ItemCell::resizeEvent(event);
     if(!m_isAnimated) scaleImages();
-    else if(m_movie) scaleMovieFrame(); // 缩放当前帧
+    else if(m_movie)
+    {
+        // 连续缩放期间不写入帧缓存，停止后再按最终尺寸缓存
+        m_rescaleTimer->start();
+        scaleMovieFrame();
+    }
+}
+
+void ImageItemCell::showEvent(QShowEvent *event)
+{
+    ItemCell::showEvent(event);
+    m_shown = true;
+    updatePlayback();
+}
+
+// 标签页切走、窗口最小化时子控件也会收到hideEvent
+void ImageItemCell::hideEvent(QHideEvent *event)
+{
+    ItemCell::hideEvent(event);
+    m_shown = false;
+    updatePlayback();
 }
 
 void ImageItemCell::mousePressEvent(QMouseEvent *event)
@@ -153,22 +204,12 @@ void ImageItemCell::dropEvent(QDropEvent *event)
 
     if(mimeData->hasImage())
     {
-        // 从剪贴板或其他应用的图片数据
-        QPixmap pixmap = qvariant_cast<QPixmap>(mimeData->imageData());
-        if(!pixmap.isNull())
+        // 从剪贴板或其他应用的图片数据，编码和入库在后台进行
+        QImage image = qvariant_cast<QImage>(mimeData->imageData());
+        if(!image.isNull())
         {
-            // 保存到临时文件
-            QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-            QString fileName = tempDir + "/dropped_image_" +
-                              QString::number(QDateTime::currentSecsSinceEpoch()) + ".png";
-
-            if(pixmap.save(fileName, "PNG"))
-            {
-                m_item.content = fileName;
-                updateContent();
-                emit contentChanged(m_item);
-                event->acceptProposedAction();
-            }
+            startIngest(ImageIngestor::getImageIngestor()->ingestImage(image, QSize(m_imageLabel->width(), QWIDGETSIZE_MAX)));
+            event->acceptProposedAction();
         }
     }
     else if(mimeData->hasUrls())
@@ -208,17 +249,30 @@ void ImageItemCell::selectImage()
         QFileInfo fileInfo(fileName);
         settings.setValue("lastImageDir", fileInfo.path());
 
-        m_item.content = fileName;
-        updateContent();
-        emit contentChanged(m_item);
+        startIngest(ImageIngestor::getImageIngestor()->ingestFile(fileName, QSize(m_imageLabel->width(), QWIDGETSIZE_MAX)));
+    }
+}
+
+void ImageItemCell::pasteImage()
+{
+    const QMimeData *mimeData = QApplication::clipboard()->mimeData();
+    if(!mimeData) return;
+
+    if(mimeData->hasImage())
+    {
+        QImage image = qvariant_cast<QImage>(mimeData->imageData());
+        if(!image.isNull())
+            startIngest(ImageIngestor::getImageIngestor()->ingestImage(image, QSize(m_imageLabel->width(), QWIDGETSIZE_MAX)));
+    }
+    else if(mimeData->hasUrls() && !mimeData->urls().isEmpty())
+    {
+        loadImageFromUrl(mimeData->urls().first());
     }
 }
 
 void ImageItemCell::removeImage()
 {
-    m_item.content.clear();
-    updateContent();
-    emit contentChanged(m_item);
+    setImagePath("");
 }
 
 //void ImageItemCell::copyImage()
@@ -234,10 +288,10 @@ void ImageItemCell::removeImage()
 //            QApplication::clipboard()->setPixmap(currentFrame);
 //        }
 //    }
-//    else if(!m_originalPixmaps.isNull())
+//    else if(!m_displayPixmap.isNull())
 //    {
 //        // 复制静态图片
-//        QApplication::clipboard()->setPixmap(m_originalPixmaps);
+//        QApplication::clipboard()->setPixmap(m_displayPixmap);
 //    }
 //}
 
@@ -254,6 +308,11 @@ void ImageItemCell::onCustomContextMenu(const QPoint &pos)
     QMenu menu;
 
     menu.addAction("选择图片", this, [=](){selectImage();});
+    const QMimeData *clipboardData = QApplication::clipboard()->mimeData();
+    if(clipboardData && (clipboardData->hasImage() || clipboardData->hasUrls()))
+    {
+        menu.addAction("粘贴图片\tCtrl+V", this, [=](){pasteImage();});
+    }
     if(!m_item.content.isEmpty())
     {
         menu.addAction("移除图片", this, [=](){removeImage();});
@@ -269,66 +328,151 @@ void ImageItemCell::onCustomContextMenu(const QPoint &pos)
     menu.exec(mapToGlobal(pos));
 }
 
-void ImageItemCell::scaleImages(double scaleFactor)
+void ImageItemCell::scaleImages()
+{
+    if(!m_sourceSize.isValid() || m_ingesting) return; // 入库期间保持占位
+
+    QSize size = displaySize();
+    if(size.isEmpty()) return;
+    // 还没有解码结果（首次显示）时直接解码
+    if(m_displayPixmap.isNull())
+    {
+        requestDecode(size);
+        return;
+    }
+
+    // 缩放过程中用快速变换，停止后重新解码（解码结果可能与目标尺寸有一像素的取整差异）
+    if(size != m_decodingSize)
+    {
+        m_imageLabel->setPixmap(m_displayPixmap.scaled(size, Qt::KeepAspectRatio, Qt::FastTransformation));
+        m_rescaleTimer->start();
+    }
+    else m_imageLabel->setPixmap(m_displayPixmap);
+}
+
+// 保持宽高比，宽度不超过标签，不放大
+QSize ImageItemCell::displaySize() const
 {
-    m_scaleFactors = scaleFactor;
+    if(!m_sourceSize.isValid()) return QSize();
+    int width = m_imageLabel->width();
+    if(width <= 0) return QSize();
+    if(m_sourceSize.width() <= width) return m_sourceSize;
+    return QSize(width, qMax(1, int(qint64(m_sourceSize.height()) * width / m_sourceSize.width())));
+}
 
-    if(m_originalPixmaps.isNull()) return;
+void ImageItemCell::requestDecode(const QSize &size)
+{
+    if(size.isEmpty() || m_item.content.isEmpty()) return;
+    if(size == m_decodingSize) return; // 正在解码或已经是该尺寸
+
+    m_decodingSize = size;
+    QString path = m_item.content;
+    // 其他单元格或之前打开时已解码过同一尺寸
+    QPixmap cached = ThumbnailCache::getThumbnailCache()->cached(path, size);
+    if(!cached.isNull())
+    {
+        m_pendingDecodeSize = QSize(); // 仍在进行的旧任务结果作废
+        m_displayPixmap = cached;
+        scaleImages();
+        return;
+    }
+    // 替换正在等待的任务，旧任务的结果不会再送达
+    m_pendingDecodeSize = size;
+    m_decodeWatcher->setFuture(QtConcurrent::run([=](){
+        return ThumbnailCache::decodeScaled(path, size);
+    }));
+}
 
-    // 计算缩放后的尺寸，保持宽高比
-    QSize newSize = m_originalPixmaps.size() * scaleFactor;
-    if(newSize.width() > m_imageLabel->width())
+void ImageItemCell::onDecodeFinished()
+{
+    if(m_ingesting) return; // 旧图片的结果，新图片入库后会重新显示
+    // 图片已被替换或已从缓存取得
+    if(m_pendingDecodeSize.isEmpty() || m_pendingDecodeSize != m_decodingSize) return;
+    m_pendingDecodeSize = QSize();
+    QImage image = m_decodeWatcher->result();
+    if(image.isNull())
     {
-        newSize.setWidth(m_imageLabel->width());
-        newSize.setHeight(m_originalPixmaps.size().height() * m_imageLabel->width() /
-                          m_originalPixmaps.size().width());
+        m_imageLabel->setText(QString("无法加载图片: %1").arg(m_item.content));
+        return;
     }
 
-    QPixmap scaledPix = m_originalPixmaps.scaled(newSize, Qt::KeepAspectRatio, Qt::SmoothTransformation );
-    m_imageLabel->setPixmap(scaledPix);
+    m_displayPixmap = QPixmap::fromImage(image);
+    ThumbnailCache::getThumbnailCache()->insert(m_item.content, m_decodingSize, m_displayPixmap);
+    // 解码期间宽度又变化时先快速缩放，停止后再次解码
+    scaleImages();
 }
 
 void ImageItemCell::scaleMovieFrame()
 {
     if(!m_movie || !m_movie->isValid()) return;
 
-    QPixmap currentFrame = m_movie->currentPixmap();
-    if(currentFrame.isNull()) return;
+    QSize size = displaySize();
+    if(size.isEmpty()) return;
 
-    // 计算缩放后的尺寸，保持宽高比
-    QSize newSize = currentFrame.size();
-    if(newSize.width() > m_imageLabel->width())
+    // 缩放过程中用快速变换且不缓存，否则每个中间尺寸都会占用帧缓存
+    if(m_rescaleTimer->isActive())
     {
-        newSize.setWidth(m_imageLabel->width());
-        newSize.setHeight(currentFrame.size().height() * m_imageLabel->width() /
-                          currentFrame.size().width());
+        QPixmap currentFrame = m_movie->currentPixmap();
+        if(!currentFrame.isNull())
+            m_imageLabel->setPixmap(currentFrame.scaled(size, Qt::KeepAspectRatio, Qt::FastTransformation));
     }
-
-    QPixmap scaledPix = currentFrame.scaled(newSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    m_imageLabel->setPixmap(scaledPix);
+    else m_imageLabel->setPixmap(m_movie->scaledFrame(size));
 }
 
 void ImageItemCell::setupMovie(const QString &fileName)
 {
-    m_movie = new QMovie(fileName);
-    m_movie->setCacheMode(QMovie::CacheAll);
+    m_movie = MovieCache::getMovieCache()->acquire(fileName);
 
-    // 连接帧变化信号
-    QObject::connect(m_movie, &QMovie::frameChanged, this, &ImageItemCell::updateAnimation);
-    // 开始播放动画
-    m_movie->start();
-
-    // 设置第一帧
-    if(m_movie->isValid()) scaleMovieFrame(); // 立即更新第一帧
+    if(m_movie && m_movie->isValid())
+    {
+        m_sourceSize = m_movie->frameSize();
+        scaleMovieFrame(); // 立即显示当前帧
+        updatePlayback();
+    }
     else
     {
         m_imageLabel->setText("无法加载GIF动画");
-        delete m_movie;
-        m_movie = nullptr;
+        releaseMovie();
         m_isAnimated = false;
     }
 }
 
+void ImageItemCell::releaseMovie()
+{
+    if(!m_movie) return;
+
+    if(m_viewing)
+    {
+        QObject::disconnect(m_movie, nullptr, this, nullptr);
+        m_movie->removeViewer();
+        m_viewing = false;
+    }
+    MovieCache::getMovieCache()->release(m_movie);
+    m_movie = nullptr;
+}
+
+// 只在可见时观看：不可见的单元格不接收帧，最后一个观看者离开时动画暂停
+void ImageItemCell::updatePlayback()
+{
+    if(!m_movie) return;
+
+    bool viewing = m_shown && m_onScreen;
+    if(viewing == m_viewing) return;
+    m_viewing = viewing;
+
+    if(viewing)
+    {
+        QObject::connect(m_movie, &SharedMovie::frameChanged, this, &ImageItemCell::updateAnimation);
+        m_movie->addViewer();
+        scaleMovieFrame(); // 暂停期间其他单元格可能推进了共享的帧
+    }
+    else
+    {
+        QObject::disconnect(m_movie, nullptr, this, nullptr);
+        m_movie->removeViewer();
+    }
+}
+
 void ImageItemCell::startDrag()
 {
     QDrag *drag = new QDrag(this);
@@ -342,8 +486,12 @@ void ImageItemCell::startDrag()
             mimeData->setImageData(dragPixmap.toImage());
 
     }
-    else if(!m_originalPixmaps.isNull())
-        mimeData->setImageData(m_originalPixmaps.toImage());
+    else if(!m_displayPixmap.isNull())
+    {
+        // 原图只在拖拽时读取
+        QImage image(m_item.content);
+        mimeData->setImageData(image.isNull() ? m_displayPixmap.toImage() : image);
+    }
 
     // 设置文件路径
     QList<QUrl> urls;
@@ -355,7 +503,7 @@ void ImageItemCell::startDrag()
     // 设置拖拽时的缩略图
     QPixmap dragPixmap;
     if(m_isAnimated && m_movie) dragPixmap = m_movie->currentPixmap();
-    else dragPixmap = m_originalPixmaps;
+    else dragPixmap = m_displayPixmap;
 
     if(!dragPixmap.isNull())
     {
@@ -382,13 +530,49 @@ bool ImageItemCell::loadImageFromUrl(const QUrl &url)
         // 检查文件是否为支持的图片格式
         QStringList imageExtensions = {"png", "jpg", "jpeg", "bmp", "gif", "svg", "webp", "ico"};
         QFileInfo fileInfo(filePath);
-        if(imageExtensions.contains(fileInfo.suffix().toLower()))
+        if(imageExtensions.contains(fileInfo.suffix().toLower()) && fileInfo.isFile())
         {
-            m_item.content = filePath;
-            updateContent();
-            emit contentChanged(m_item);
+            startIngest(ImageIngestor::getImageIngestor()->ingestFile(filePath, QSize(m_imageLabel->width(), QWIDGETSIZE_MAX)));
             return true;
         }
     }
     return false;
 }
+
+// 旧图片是否仍被使用由BlobStore回收时根据已保存的笔记判断
+void ImageItemCell::setImagePath(const QString &blobPath)
+{
+    m_item.content = blobPath;
+    updateContent();
+    emit contentChanged();
+}
+
+void ImageItemCell::startIngest(const QFuture<IngestResult> &future)
+{
+    // 被新的入库替换时，旧任务的结果不再送达
+    m_ingesting = true;
+    m_ingestWatcher->setFuture(future);
+
+    // 占位：停止旧图片的动画和解码，显示进度文字
+    releaseMovie();
+    m_rescaleTimer->stop();
+    m_imageLabel->setPixmap(QPixmap());
+    m_imageLabel->setText("正在导入图片...");
+}
+
+void ImageItemCell::onIngestFinished()
+{
+    if(!m_ingesting) return;
+    m_ingesting = false;
+
+    IngestResult result = m_ingestWatcher->result();
+    if(result.blobPath.isEmpty())
+    {
+        qWarning() << "Failed to ingest the image";
+        updateContent(); // 恢复原图片
+        return;
+    }
+
+    m_ingestPreview = result.preview;
+    setImagePath(result.blobPath);
+}
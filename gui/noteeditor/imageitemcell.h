@@ -9,18 +9,32 @@
 * @description
 *           ==== 布局 ====
 *           ==== 核心功能 ====
+*           - 静态图片不保留原图：用QImageReader按显示尺寸在后台解码，内存只与显示尺寸有关
+*           - 连续缩放（拖动分割条）时用快速变换缩放已解码的图片，停止一段时间后
+*             再在后台按新尺寸平滑解码；解码结果存入ThumbnailCache，同一图片同一尺寸只解码一次
+*           - GIF通过MovieCache共享解码器，只在单元格可见（在可视区域内且所在标签页显示）时播放，
+*             缩放后的帧存入ThumbnailCache（以帧号区分），与静态图片共用内存预算
+*           - 选择、拖入、粘贴的图片交给ImageIngestor在后台编码、哈希和入库，期间显示占位文字，
+*             完成后直接使用后台解码的预览图
 *           ==== 使用说明 ====
 *           ==== 注意 ====
 *           复制图片需要重写（复制图片到，复制为路径、markdown、html）
 *           需要加入放大缩小
+*           图片统一存入BlobStore，m_item.content为存储内的稳定路径
 *
 * @author   无声目
 * @date     2025/09/27
 * @history
 *****************************************************/
 #include "itemcell.h"
+#include "imageingestor.h"
+
+#include <QFutureWatcher>
+#include <QImage>
 
 class QLabel;
+class QTimer;
+class SharedMovie;
 class ImageItemCell : public ItemCell
 {
     Q_OBJECT
@@ -28,10 +42,15 @@ public:
     explicit ImageItemCell(NoteItem item, QWidget *parent = nullptr);
     ~ImageItemCell();
 
+    void setOnScreen(bool onScreen) override;
+    bool isBusy() const override { return m_ingesting; } // 入库结果回来前释放会丢失图片路径
+
 signals:
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *event) override;
@@ -40,6 +59,7 @@ protected:
 
 private slots:
     void selectImage();
+    void pasteImage();
     void removeImage();
 //    void copyImage();
     void updateAnimation();
@@ -48,18 +68,36 @@ private slots:
 private:
     void initUI() override;
     void updateContent() override;
-    void scaleImages(double scaleFactor = 1.0);
+    void scaleImages();                 // 快速缩放当前图片，并在停止缩放后重新解码
+    QSize displaySize() const;          // 当前宽度下的显示尺寸（不放大）
+    void requestDecode(const QSize& size);
+    void onDecodeFinished();
     void scaleMovieFrame();
-    void setupMovie(const QString& fileName); // 设置QMovie
+    void setupMovie(const QString& fileName); // 取得共享动画
+    void releaseMovie();
+    void updatePlayback();              // 按可见性开始或暂停观看动画
     void startDrag(); // 开始拖拽操作
     bool loadImageFromUrl(const QUrl& url); // 从URL加载图片
+    void startIngest(const QFuture<IngestResult>& future); // 后台入库，完成后替换图片
+    void onIngestFinished();
+    void setImagePath(const QString& blobPath); // 替换图片
 
     QLabel *m_imageLabel = nullptr;
-    QMovie *m_movie = nullptr;
+    SharedMovie *m_movie = nullptr;
 
-    QPixmap m_originalPixmaps;
-    double m_scaleFactors = 1.0;
+    QPixmap m_displayPixmap;            // 按显示尺寸解码的图片
+    QSize m_sourceSize;                 // 原图尺寸（只读取文件头）
+    QSize m_decodingSize;               // 正在或最后一次请求解码的尺寸
+    QSize m_pendingDecodeSize;          // 后台解码任务的尺寸，结果不再需要时为空
+    QTimer *m_rescaleTimer = nullptr;   // 缩放防抖
+    QFutureWatcher<QImage> *m_decodeWatcher = nullptr;
+    QFutureWatcher<IngestResult> *m_ingestWatcher = nullptr;
+    bool m_ingesting = false;           // 有未取走结果的入库任务
+    QImage m_ingestPreview;             // 入库时解码的预览图，updateContent中使用
     bool m_isAnimated = false;
+    bool m_shown = false;               // 收到showEvent且未隐藏（标签页切走、窗口最小化时为false）
+    bool m_onScreen = true;             // 在滚动区域的可视范围内
+    bool m_viewing = false;             // 已作为观看者加入m_movie
     QPoint m_dragStartPosition; // 拖拽起始位置
 };
 
@@ -7,6 +7,11 @@ ItemCell::ItemCell(NoteItem item, QWidget *parent)
 
 NoteItem ItemCell::item() const
 {
+    if(m_dirty)
+    {
+        m_item.content = currentContent();
+        m_dirty = false;
+    }
     return m_item;
 }
 
@@ -14,9 +19,56 @@ void ItemCell::setItem(const NoteItem &item)
 {
     m_item = item;
     updateContent();
+    m_dirty = false;
+}
+
+bool ItemCell::isDirty() const
+{
+    return m_dirty;
 }
 
 void ItemCell::setFixed(bool fixed)
 {
     m_fixed = fixed;
 }
+
+// 默认不关心可见性，有后台工作（如动画）的单元格重写
+void ItemCell::setOnScreen(bool onScreen)
+{
+    Q_UNUSED(onScreen)
+}
+
+bool ItemCell::isBusy() const
+{
+    return false;
+}
+
+NoteItem ItemCell::snapshotItem() const
+{
+    return item();
+}
+
+bool ItemCell::hasPendingContent() const
+{
+    return false;
+}
+
+void ItemCell::storePendingContent()
+{
+}
+
+void ItemCell::storePendingContentNow()
+{
+}
+
+QString ItemCell::currentContent() const
+{
+    return m_item.content;
+}
+
+// 编辑时只做标记，不复制内容，输入代价与笔记大小无关
+void ItemCell::markDirty()
+{
+    m_dirty = true;
+    emit contentChanged();
+}
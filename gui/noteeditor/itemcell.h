@@ -11,13 +11,23 @@ public:
     explicit ItemCell(NoteItem item, QWidget *parent = nullptr);
     virtual ~ItemCell() = default;
 
-    NoteItem item() const;
+    NoteItem item() const;              // 有未同步的修改时先从编辑器取出内容
     virtual void setItem(const NoteItem &item);
+    bool isDirty() const;
 
     void setFixed(bool fixed);
+    virtual void setOnScreen(bool onScreen); // 是否在滚动区域的可视范围内，由NoteEditor设置
+    virtual bool isBusy() const;        // 有未完成的后台任务（如图片入库），此时不能释放
+    virtual NoteItem snapshotItem() const; // 完整内容的副本，在单元格之间复制内容时使用
+
+    // 保存前需要写出的内容（如代码项的大内容入库），默认没有
+    virtual bool hasPendingContent() const;
+    virtual void storePendingContent();     // 后台写出，完成后发出contentStored()
+    virtual void storePendingContentNow();  // 立即写出（关闭标签页时）
 
 signals:
-    void contentChanged(const NoteItem &item);
+    void contentChanged();              // 内容被修改，需要时再通过item()取出
+    void contentStored();               // storePendingContent()完成
     void removeRequested();
 //    void moveUpRequested();
 //    void moveDownRequested();
@@ -25,8 +35,11 @@ signals:
 protected:
     virtual void initUI() = 0;
     virtual void updateContent() = 0;
+    virtual QString currentContent() const; // 编辑器中的当前内容，默认即m_item.content
+    void markDirty();
 
-    NoteItem m_item;
+    mutable NoteItem m_item;
+    mutable bool m_dirty = false;
     bool m_fixed;
 };
 
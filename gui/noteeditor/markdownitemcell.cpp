@@ -1,11 +1,33 @@
 #include "markdownitemcell.h"
+#include "slicedmarkdownhighlighter.h"
 #include "stylemanager.h"
 
 #include <QDebug>
 #include <QHBoxLayout>
 #include <QMenu>
+#include <QScrollBar>
+#include <QTimer>
 #include <qmarkdowntextedit.h>
 
+namespace {
+// 用分片高亮器替换QMarkdownTextEdit默认的高亮器
+class SlicedMarkdownTextEdit : public QMarkdownTextEdit
+{
+public:
+    explicit SlicedMarkdownTextEdit(QWidget *parent = nullptr)
+        : QMarkdownTextEdit(parent, false)
+    {
+        _highlighter = new SlicedMarkdownHighlighter(document());
+        _highlightingEnabled = true;
+    }
+
+    SlicedMarkdownHighlighter *slicedHighlighter() const
+    {
+        return static_cast<SlicedMarkdownHighlighter*>(_highlighter);
+    }
+};
+}
+
 MarkdownItemCell::MarkdownItemCell(NoteItem item, QWidget *parent)
     : ItemCell(item, parent)
 {
@@ -28,7 +50,9 @@ void MarkdownItemCell::initUI()
     contentWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     QVBoxLayout *contentVLayout = new QVBoxLayout(contentWidget);
     contentVLayout->setContentsMargins(0, 0, 0, 0);
-    m_markdownEdit = new QMarkdownTextEdit;
+    SlicedMarkdownTextEdit *markdownEdit = new SlicedMarkdownTextEdit;
+    m_markdownEdit = markdownEdit;
+    m_highlighter = markdownEdit->slicedHighlighter();
     m_markdownEdit->setContextMenuPolicy(Qt::NoContextMenu);
     m_markdownEdit->setFixedHeight(500);
     m_markdownEdit->setPlaceholderText("开始编写 Markdown 文档...\n\n"
@@ -43,9 +67,10 @@ void MarkdownItemCell::initUI()
                                        "• Ctrl + Alt + ↓ - 复制当前行\n"
                                        "• Ctrl + Click - 打开链接");
     QObject::connect(m_markdownEdit, &QMarkdownTextEdit::textChanged, [=](){
-        m_item.content = m_markdownEdit->toPlainText();
-        emit contentChanged(m_item);
+        markDirty();
     });
+    QObject::connect(m_markdownEdit->verticalScrollBar(), &QScrollBar::valueChanged,
+                     this, &MarkdownItemCell::updateVisibleBlocks);
 
     contentVLayout->addWidget(m_markdownEdit);
 
@@ -54,9 +79,24 @@ void MarkdownItemCell::initUI()
     updateContent();
 }
 
+QString MarkdownItemCell::currentContent() const
+{
+    return m_markdownEdit->toPlainText();
+}
+
 void MarkdownItemCell::updateContent()
 {
+    // 新内容从顶部显示，先按前几十块高亮，布局完成后再取实际范围
+    m_highlighter->setVisibleBlocks(0, 60);
     m_markdownEdit->setText(m_item.content);
+    QTimer::singleShot(0, this, &MarkdownItemCell::updateVisibleBlocks);
+}
+
+void MarkdownItemCell::updateVisibleBlocks()
+{
+    int first = m_markdownEdit->cursorForPosition(QPoint(0, 0)).blockNumber();
+    int last = m_markdownEdit->cursorForPosition(QPoint(0, m_markdownEdit->viewport()->height())).blockNumber();
+    m_highlighter->setVisibleBlocks(first, last);
 }
 
 void MarkdownItemCell::onCustomContextMenu(const QPoint &pos)
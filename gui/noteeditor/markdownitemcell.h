@@ -5,6 +5,7 @@
 
 class QToolButton;
 class QMarkdownTextEdit;
+class SlicedMarkdownHighlighter;
 class MarkdownItemCell : public ItemCell
 {
     Q_OBJECT
@@ -19,7 +20,10 @@ private slots:
 private:
     void initUI() override;
     void updateContent() override;
+    QString currentContent() const override;
+    void updateVisibleBlocks();         // 把编辑器可视范围告诉高亮器，优先高亮
     QMarkdownTextEdit *m_markdownEdit;
+    SlicedMarkdownHighlighter *m_highlighter = nullptr;
 };
 
 #endif // MARKDOWNITEMCELL_H
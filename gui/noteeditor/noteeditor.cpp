@@ -5,6 +5,11 @@
 #include "markdownitemcell.h"
 #include "textitemcell.h"
 
+#include <QApplication>
+#include <QEvent>
+#include <QScrollArea>
+#include <QScrollBar>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QToolButton>
 
@@ -14,23 +19,77 @@ NoteEditor::NoteEditor(QWidget *parent)
     initUI();
 }
 
+void NoteEditor::setScrollArea(QScrollArea *scrollArea)
+{
+    if(m_scrollArea)
+    {
+        m_scrollArea->verticalScrollBar()->disconnect(this);
+        m_scrollArea->viewport()->removeEventFilter(this);
+    }
+
+    m_scrollArea = scrollArea;
+    if(m_scrollArea)
+    {
+        QScrollBar *scrollBar = m_scrollArea->verticalScrollBar();
+        QObject::connect(scrollBar, &QScrollBar::valueChanged, this, &NoteEditor::scheduleVisibilityUpdate);
+        QObject::connect(scrollBar, &QScrollBar::rangeChanged, this, &NoteEditor::scheduleVisibilityUpdate);
+        m_scrollArea->viewport()->installEventFilter(this);
+    }
+    scheduleVisibilityUpdate();
+}
+
 void NoteEditor::setNoteItems(const QList<NoteItem> &items)
 {
     clearItems();
-    m_NoteItems = items;
+    for(const auto &item : items)
+    {
+        appendItem(item);
+    }
+    m_dirtyIds.clear();
+    m_restructured = false;
     updateContent();
 }
 
 QList<NoteItem> NoteEditor::noteItems() const
 {
     QList<NoteItem> items;
-    for(auto widget : m_itemCells)
+    for(const auto &slot : m_slots)
     {
-        items.append(widget->item());
+        items.append(slot.cell ? slot.cell->item() : slot.item);
     }
     return items;
 }
 
+// 增删过项时整体重建，否则只取出有修改的项，其余项保持共享不复制
+void NoteEditor::syncItems(QList<NoteItem> &items)
+{
+    if(m_restructured || items.size() != m_slots.size())
+    {
+        items = noteItems();
+    }
+    else if(!m_dirtyIds.isEmpty())
+    {
+        for(int i = 0; i < m_slots.size(); i++)
+        {
+            const CellSlot &slot = m_slots[i];
+            if(!m_dirtyIds.contains(slot.id)) continue;
+            items[i] = slot.cell ? slot.cell->item() : slot.item;
+        }
+    }
+    m_dirtyIds.clear();
+    m_restructured = false;
+}
+
+QList<ItemCell*> NoteEditor::cells() const
+{
+    QList<ItemCell*> result;
+    for(const auto &slot : m_slots)
+    {
+        if(slot.cell) result.append(slot.cell);
+    }
+    return result;
+}
+
 void NoteEditor::addTextItem()
 {
     NoteItem item;
@@ -38,15 +97,11 @@ void NoteEditor::addTextItem()
     item.content = "";
     item.language = "";
 
-    TextItemCell *widget = new TextItemCell(item, this);
-    QObject::connect(widget, &TextItemCell::removeRequested, [=](){removeItem(widget);});
-    QObject::connect(widget, &TextItemCell::contentChanged,
-                     this, &NoteEditor::itemContentChanged);
+    // 新项添加在末尾，立即创建以便直接编辑
+    appendItem(item);
+    materialize(m_slots.last());
 
-    m_mainVLayout->addWidget(widget);
-    m_itemCells.append(widget);
-
-    emit noteItemsChanged(noteItems());
+    itemsRestructured();
 }
 
 void NoteEditor::addImageItem()
@@ -56,15 +111,10 @@ void NoteEditor::addImageItem()
     item.content = "";
     item.language = "";
 
-    ImageItemCell *widget = new ImageItemCell(item, this);
-    QObject::connect(widget, &ImageItemCell::removeRequested, [=](){removeItem(widget);});
-    QObject::connect(widget, &ImageItemCell::contentChanged,
-                     this, &NoteEditor::itemContentChanged);
-
-    m_mainVLayout->addWidget(widget);
-    m_itemCells.append(widget);
+    appendItem(item);
+    materialize(m_slots.last());
 
-    emit noteItemsChanged(noteItems());
+    itemsRestructured();
 }
 
 void NoteEditor::addMarkdownItem()
@@ -74,15 +124,10 @@ void NoteEditor::addMarkdownItem()
     item.content = "";
     item.language = "";
 
-    MarkdownItemCell *widget = new MarkdownItemCell(item, this);
-    QObject::connect(widget, &MarkdownItemCell::removeRequested, [=](){removeItem(widget);});
-    QObject::connect(widget, &MarkdownItemCell::contentChanged,
-                     this, &NoteEditor::itemContentChanged);
-
-    m_mainVLayout->addWidget(widget);
-    m_itemCells.append(widget);
+    appendItem(item);
+    materialize(m_slots.last());
 
-    emit noteItemsChanged(noteItems());
+    itemsRestructured();
 }
 
 void NoteEditor::addCodeItem()
@@ -92,15 +137,10 @@ void NoteEditor::addCodeItem()
     item.content = "";
     item.language = "C++";
 
-    CodeItemCell *widget = new CodeItemCell(item, this);
-    QObject::connect(widget, &CodeItemCell::removeRequested, [=](){removeItem(widget);});
-    QObject::connect(widget, &CodeItemCell::contentChanged,
-                     this, &NoteEditor::itemContentChanged);
+    appendItem(item);
+    materialize(m_slots.last());
 
-    m_mainVLayout->addWidget(widget);
-    m_itemCells.append(widget);
-
-    emit noteItemsChanged(noteItems());
+    itemsRestructured();
 }
 
 void NoteEditor::removeItem(ItemCell *itemCell)
@@ -108,17 +148,34 @@ void NoteEditor::removeItem(ItemCell *itemCell)
     int index = findItemIndex(itemCell);
     if(index != -1)
     {
-        m_mainVLayout->removeWidget(itemCell);
-        m_itemCells.removeAt(index);
-        delete itemCell;
+        QWidget *container = m_slots[index].container;
+        m_mainVLayout->removeWidget(container);
+        m_slots.removeAt(index);
+        delete container;
+
+        itemsRestructured();
+    }
+}
+
+void NoteEditor::itemContentChanged(quint64 id)
+{
+    m_dirtyIds.insert(id);
+    emit contentEdited();
+}
 
-        emit noteItemsChanged(noteItems());
+bool NoteEditor::eventFilter(QObject *watched, QEvent *event)
+{
+    if(m_scrollArea && watched == m_scrollArea->viewport() && event->type() == QEvent::Resize)
+    {
+        scheduleVisibilityUpdate();
     }
+    return QWidget::eventFilter(watched, event);
 }
 
-void NoteEditor::itemContentChanged()
+void NoteEditor::showEvent(QShowEvent *event)
 {
-    emit noteItemsChanged(noteItems());
+    QWidget::showEvent(event);
+    scheduleVisibilityUpdate();
 }
 
 void NoteEditor::initUI()
@@ -126,52 +183,201 @@ void NoteEditor::initUI()
     m_mainVLayout = new QVBoxLayout(this);
     m_mainVLayout->setContentsMargins(0, 0, 0, 0);
     m_mainVLayout->setSpacing(10);
+
+    m_visibilityTimer = new QTimer(this);
+    m_visibilityTimer->setSingleShot(true);
+    m_visibilityTimer->setInterval(0);
+    QObject::connect(m_visibilityTimer, &QTimer::timeout, this, &NoteEditor::updateVisibleCells);
 }
 
 void NoteEditor::updateContent()
 {
-    for(const auto &item : m_NoteItems)
+    // 单元格在布局完成后按可视区域创建
+    scheduleVisibilityUpdate();
+}
+
+void NoteEditor::clearItems()
+{
+    for(const auto &slot : m_slots)
     {
-        ItemCell *widget = nullptr;
+        m_mainVLayout->removeWidget(slot.container);
+        delete slot.container;
+    }
+    m_slots.clear();
+}
 
-        switch(item.type)
-        {
-        case NType::Text:
-            widget = new TextItemCell(item, this);
-            break;
-        case NType::Image:
-            widget = new ImageItemCell(item, this);
-            break;
-        case NType::Markdown:
-            widget = new MarkdownItemCell(item, this);
-            break;
-        case NType::Code:
-            widget = new CodeItemCell(item, this);
-            break;
-        }
+int NoteEditor::findItemIndex(ItemCell *itemCell) const
+{
+    if(!itemCell) return -1;
+    for(int i = 0; i < m_slots.size(); i++)
+    {
+        if(m_slots[i].cell == itemCell) return i;
+    }
+    return -1;
+}
 
-        if(widget)
-        {
-            QObject::connect(widget, &ItemCell::removeRequested, [=](){removeItem(widget);});
-            QObject::connect(widget, &ItemCell::contentChanged,
-                             this, &NoteEditor::itemContentChanged);
-            m_mainVLayout->insertWidget(m_mainVLayout->count() - 1, widget);
-            m_itemCells.append(widget);
-        }
+void NoteEditor::appendItem(const NoteItem &item)
+{
+    CellSlot slot;
+    slot.id = m_nextId++;
+    slot.item = item;
+    slot.height = estimatedHeight(item);
+    slot.container = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(slot.container);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    slot.container->setFixedHeight(slot.height);
+
+    m_mainVLayout->addWidget(slot.container);
+    m_slots.append(slot);
+}
+
+void NoteEditor::itemsRestructured()
+{
+    m_restructured = true;
+    emit contentEdited();
+}
+
+void NoteEditor::materialize(CellSlot &slot)
+{
+    if(slot.cell) return;
+    ItemCell *cell = createCell(slot.item, slot.container);
+    if(!cell) return;
+
+    quint64 id = slot.id;
+    QObject::connect(cell, &ItemCell::removeRequested, [=](){removeItem(cell);});
+    QObject::connect(cell, &ItemCell::contentChanged, [=](){itemContentChanged(id);});
+
+    slot.cell = cell;
+    slot.item = NoteItem(); // 内容以单元格为准
+    slot.container->setMinimumHeight(0);
+    slot.container->setMaximumHeight(QWIDGETSIZE_MAX);
+    slot.container->layout()->addWidget(cell);
+}
+
+void NoteEditor::release(CellSlot &slot)
+{
+    if(!slot.cell) return;
+
+    slot.item = slot.cell->item();
+    slot.height = slot.container->height();
+    slot.container->layout()->removeWidget(slot.cell);
+    delete slot.cell;
+    slot.cell = nullptr;
+    slot.container->setFixedHeight(slot.height);
+}
+
+ItemCell *NoteEditor::createCell(const NoteItem &item, QWidget *parent)
+{
+    ItemCell *widget = nullptr;
+
+    switch(item.type)
+    {
+    case NType::Text:
+        widget = new TextItemCell(item, parent);
+        break;
+    case NType::Image:
+        widget = new ImageItemCell(item, parent);
+        break;
+    case NType::Markdown:
+        widget = new MarkdownItemCell(item, parent);
+        break;
+    case NType::Code:
+        widget = new CodeItemCell(item, parent);
+        break;
     }
+
+    return widget;
 }
 
-void NoteEditor::clearItems()
+// 尚未创建过的单元格按类型估计高度，与各单元格的固定/最小高度大致相同
+int NoteEditor::estimatedHeight(const NoteItem &item)
 {
-    for(auto widget : m_itemCells)
+    switch(item.type)
     {
-        m_mainVLayout->removeWidget(widget);
-        delete widget;
+    case NType::Code:
+        return 340;     // 工具栏 + 编辑器最小高度300
+    case NType::Markdown:
+        return 510;     // 编辑器固定高度500
+    case NType::Image:
+        return 300;
+    case NType::Text:
+    default:
+        return qBound(40, 20 * (item.content.count('\n') + 1) + 20, 2000);
     }
-    m_itemCells.clear();
 }
 
-int NoteEditor::findItemIndex(ItemCell *itemCell) const
+void NoteEditor::scheduleVisibilityUpdate()
+{
+    m_visibilityTimer->start();
+}
+
+void NoteEditor::updateVisibleCells()
 {
-    return m_itemCells.indexOf(itemCell);
+    if(m_slots.isEmpty()) return;
+
+    // 没有滚动区域时无法判断可见性，全部创建
+    if(!m_scrollArea || !m_scrollArea->widget())
+    {
+        for(auto &slot : m_slots)
+        {
+            materialize(slot);
+        }
+        return;
+    }
+    if(!isVisible()) return;
+
+    QWidget *content = m_scrollArea->widget();
+    if(content->layout()) content->layout()->activate();
+    m_mainVLayout->activate();
+
+    // 可视区域换算到本控件坐标
+    QScrollBar *scrollBar = m_scrollArea->verticalScrollBar();
+    int viewportHeight = qMax(1, m_scrollArea->viewport()->height());
+    int visibleTop = scrollBar->value() - mapTo(content, QPoint(0, 0)).y();
+    int visibleBottom = visibleTop + viewportHeight;
+    int preloadTop = visibleTop - m_preloadScreens * viewportHeight;
+    int preloadBottom = visibleBottom + m_preloadScreens * viewportHeight;
+    int releaseTop = visibleTop - m_releaseScreens * viewportHeight;
+    int releaseBottom = visibleBottom + m_releaseScreens * viewportHeight;
+
+    QWidget *focusWidget = QApplication::focusWidget();
+    int scrollDelta = 0;
+    for(auto &slot : m_slots)
+    {
+        int slotTop = slot.container->y();
+        int slotBottom = slotTop + slot.container->height();
+
+        if(!slot.cell && slotBottom >= preloadTop && slotTop <= preloadBottom)
+        {
+            int oldHeight = slot.container->height();
+            materialize(slot);
+            // 可视区域上方的槽位高度变化会推动可见内容，记录下来修正滚动位置
+            if(slot.cell && slotBottom <= visibleTop)
+            {
+                scrollDelta += slot.container->sizeHint().height() - oldHeight;
+            }
+        }
+        else if(slot.cell && (slotBottom < releaseTop || slotTop > releaseBottom))
+        {
+            if(focusWidget && slot.cell->isAncestorOf(focusWidget)) continue;
+            // 后台任务完成前保留，等下次滚动再释放
+            if(slot.cell->isBusy()) continue;
+            release(slot);
+        }
+
+        // 预加载范围内的单元格已创建但不在屏幕上，通知其暂停动画等工作
+        if(slot.cell) slot.cell->setOnScreen(slotBottom >= visibleTop && slotTop <= visibleBottom);
+    }
+
+    if(scrollDelta != 0)
+    {
+        // 等布局更新滚动范围后再调整
+        QPointer<QScrollArea> scrollArea = m_scrollArea;
+        QTimer::singleShot(0, this, [=](){
+            if(!scrollArea) return;
+            QScrollBar *bar = scrollArea->verticalScrollBar();
+            bar->setValue(bar->value() + scrollDelta);
+        });
+    }
 }
@@ -8,19 +8,33 @@
 *
 * @description
 *           ==== 布局 ====
+*           每个笔记项占一个槽位，从上至下排列
 *           ==== 核心功能 ====
+*           - 单元格按需创建：只有滚动到可视区域附近的槽位才创建ItemCell，
+*             其余槽位是固定高度的空白占位控件
+*           - 远离可视区域的单元格会被释放回占位控件，保留其内容和最后的实际高度
+*           - 修改按项记录：每个槽位有稳定的ID，编辑只把ID标记为已修改并发出contentEdited，
+*             内容在保存时由syncItems取出，输入代价与笔记其余部分的大小无关
 *           ==== 使用说明 ====
+*           setScrollArea设置所在的滚动区域；未设置时所有单元格都会立即创建
+*           收到contentEdited后，在需要内容时（保存、写日志）调用syncItems同步到笔记
 *           ==== 注意 ====
+*           占位控件初始高度为估计值，单元格创建后高度才准确；
+*           单元格释放后其撤销历史随之丢失，拥有焦点或有待完成工作（isBusy()）的单元格不会被释放
 *
 * @author   无声目
 * @date     2025/09/27
 * @history
 *****************************************************/
 #include <QWidget>
+#include <QPointer>
+#include <QSet>
 #include <code_types.h>
 
 class QVBoxLayout;
 class QToolButton;
+class QScrollArea;
+class QTimer;
 class ItemCell;
 class NoteEditor : public QWidget
 {
@@ -28,11 +42,14 @@ class NoteEditor : public QWidget
 public:
     explicit NoteEditor(QWidget *parent = nullptr);
 
+    void setScrollArea(QScrollArea *scrollArea);
     void setNoteItems(const QList<NoteItem> &items);
     QList<NoteItem> noteItems() const;
+    void syncItems(QList<NoteItem> &items);
+    QList<ItemCell*> cells() const;     // 已创建的单元格
 
 signals:
-    void noteItemsChanged(const QList<NoteItem> &items);
+    void contentEdited();
 
 public slots:
     void addTextItem();
@@ -43,19 +60,48 @@ public slots:
     void removeItem(ItemCell *itemCell);
 //    void moveItemUp(ItemCell *itemCell);
 //    void moveItemDown(ItemCell *itemCell);
-    void itemContentChanged();
+    void itemContentChanged(quint64 id);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
 
 private:
+    // 槽位：可视区域附近为真实的ItemCell，其余为固定高度的占位控件
+    struct CellSlot {
+        quint64 id = 0;             // 稳定ID，增删其他项时不变
+        QWidget *container = nullptr;
+        ItemCell *cell = nullptr;   // 未创建时为空
+        NoteItem item;              // 未创建时的内容
+        int height = 0;             // 占位高度（估计值或释放前的实际高度）
+    };
+
     void initUI();
     void updateContent();
     void clearItems();
     int findItemIndex(ItemCell *itemCell) const;
 
+    void appendItem(const NoteItem &item);
+    void itemsRestructured();
+    void materialize(CellSlot &slot);
+    void release(CellSlot &slot);
+    ItemCell *createCell(const NoteItem &item, QWidget *parent);
+    static int estimatedHeight(const NoteItem &item);
+
+    void scheduleVisibilityUpdate();
+    void updateVisibleCells();
+
     QVBoxLayout *m_mainVLayout = nullptr;
+    QList<CellSlot> m_slots;
+    quint64 m_nextId = 1;
+
+    QSet<quint64> m_dirtyIds;               // 内容有修改、尚未同步的项
+    bool m_restructured = false;            // 增删过项，需要整体同步
 
-    QList<NoteItem> m_NoteItems;
-    QList<ItemCell*> m_itemCells;
+    QPointer<QScrollArea> m_scrollArea;
+    QTimer *m_visibilityTimer = nullptr;    // 合并同一轮事件中的多次滚动、缩放
+    const int m_preloadScreens = 1;         // 可视区域上下各预先创建一屏
+    const int m_releaseScreens = 3;         // 超出可视区域三屏的单元格被释放
 };
 
 #endif // NOTEEDITOR_H
-
@@ -0,0 +1,198 @@
+#include "slicedmarkdownhighlighter.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QTextDocument>
+#include <QTimer>
+
+// 按条目计数，约两万个块
+QCache<QByteArray, SlicedMarkdownHighlighter::CachedBlock> SlicedMarkdownHighlighter::s_cache(20000);
+
+SlicedMarkdownHighlighter::SlicedMarkdownHighlighter(QTextDocument *parent)
+    : MarkdownHighlighter(parent)
+{
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(0);
+    QObject::connect(m_idleTimer, &QTimer::timeout, this, &SlicedMarkdownHighlighter::processPending);
+
+    // 缓存中的格式包含字体，在QApplication析构前释放
+    static bool clearOnQuit = false;
+    if(!clearOnQuit && QCoreApplication::instance())
+    {
+        clearOnQuit = true;
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [](){
+            s_cache.clear();
+        });
+    }
+}
+
+void SlicedMarkdownHighlighter::setVisibleBlocks(int first, int last)
+{
+    m_firstVisible = qMax(0, first);
+    m_lastVisible = qMax(m_firstVisible, last);
+    // 滚动到待高亮的区域时尽快处理
+    if(m_hasPending) m_idleTimer->start();
+}
+
+void SlicedMarkdownHighlighter::highlightBlock(const QString &text)
+{
+    bool force = m_forceNext;
+    m_forceNext = false;
+    bool exhausted = budgetExhausted();
+
+    // HeadlineEnd需要修正上一块；前一块待高亮时结果是临时的
+    bool cacheable = currentBlockState() != HeadlineEnd && previousBlockState() != PendingState;
+    QByteArray key;
+    if(cacheable)
+    {
+        key = cacheKey(text);
+        if(CachedBlock *cached = s_cache.object(key))
+        {
+            applyCached(*cached);
+            return;
+        }
+    }
+
+    if(!force && exhausted && !isVisibleBlock(currentBlock().blockNumber()))
+    {
+        deferBlock();
+        return;
+    }
+
+    int dirtyCount = _dirtyTextBlocks.size();
+    int previousState = previousBlockState();
+    MarkdownHighlighter::highlightBlock(text);
+
+    // 修改了其他块的结果不能单独套用
+    if(cacheable && _dirtyTextBlocks.size() == dirtyCount && previousBlockState() == previousState)
+    {
+        s_cache.insert(key, capture(text));
+    }
+}
+
+bool SlicedMarkdownHighlighter::isVisibleBlock(int blockNumber) const
+{
+    return blockNumber >= m_firstVisible && blockNumber <= m_lastVisible;
+}
+
+// 一轮从第一次highlightBlock开始，回到事件循环时结束
+bool SlicedMarkdownHighlighter::budgetExhausted()
+{
+    if(!m_inPass)
+    {
+        m_inPass = true;
+        m_passClock.start();
+        QTimer::singleShot(0, this, [=](){
+            m_inPass = false;
+        });
+    }
+    return m_passClock.elapsed() >= m_sliceMsec;
+}
+
+// 不运行正则，只记录状态，空闲时再高亮
+void SlicedMarkdownHighlighter::deferBlock()
+{
+    int blockNumber = currentBlock().blockNumber();
+    setCurrentBlockState(PendingState);
+    _ranges.remove(blockNumber);
+
+    m_scanFrom = qMin(m_scanFrom, blockNumber);
+    m_hasPending = true;
+    m_idleTimer->start();
+}
+
+QByteArray SlicedMarkdownHighlighter::cacheKey(const QString &text) const
+{
+    QTextBlock block = currentBlock();
+    int previousState = previousBlockState();
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(reinterpret_cast<const char*>(&previousState), sizeof(previousState));
+    // 标题、缩进代码块等规则会读取前后块的文本
+    for(const QString &part : {block.previous().text(), text, block.next().text()})
+    {
+        int length = part.length();
+        hash.addData(reinterpret_cast<const char*>(&length), sizeof(length));
+        hash.addData(reinterpret_cast<const char*>(part.constData()), length * int(sizeof(QChar)));
+    }
+    return hash.result();
+}
+
+void SlicedMarkdownHighlighter::applyCached(const CachedBlock &cached)
+{
+    for(const auto &range : cached.formats)
+    {
+        setFormat(range.start, range.length, range.format);
+    }
+    setCurrentBlockState(cached.state);
+
+    int blockNumber = currentBlock().blockNumber();
+    if(cached.ranges.isEmpty()) _ranges.remove(blockNumber);
+    else _ranges[blockNumber] = cached.ranges;
+    _highlightingFinished = true;
+}
+
+// 读取刚设置的格式，相邻相同的字符合并为一段
+SlicedMarkdownHighlighter::CachedBlock *SlicedMarkdownHighlighter::capture(const QString &text) const
+{
+    CachedBlock *cached = new CachedBlock;
+    QTextCharFormat current;
+    int start = 0;
+    for(int i = 0; i <= text.length(); i++)
+    {
+        QTextCharFormat charFormat = i < text.length() ? format(i) : QTextCharFormat();
+        if(i > 0 && charFormat == current) continue;
+
+        if(i > 0 && !current.properties().isEmpty())
+        {
+            QTextLayout::FormatRange range;
+            range.start = start;
+            range.length = i - start;
+            range.format = current;
+            cached->formats.append(range);
+        }
+        current = charFormat;
+        start = i;
+    }
+    cached->state = currentBlockState();
+    cached->ranges = _ranges.value(currentBlock().blockNumber());
+    return cached;
+}
+
+// 空闲时处理一个时间片：先可视范围，再从上次扫描的位置继续
+void SlicedMarkdownHighlighter::processPending()
+{
+    if(!document()) return;
+
+    m_inPass = false;
+    budgetExhausted();
+
+    bool more = highlightPendingIn(document()->findBlockByNumber(m_firstVisible), m_lastVisible, false);
+    if(!more) more = highlightPendingIn(document()->findBlockByNumber(m_scanFrom), INT_MAX, true);
+
+    m_hasPending = more;
+    if(more) m_idleTimer->start();
+}
+
+// 返回true表示时间片用完，范围内可能还有待高亮的块
+bool SlicedMarkdownHighlighter::highlightPendingIn(QTextBlock block, int lastBlock, bool advanceScan)
+{
+    while(block.isValid() && block.blockNumber() <= lastBlock)
+    {
+        if(block.userState() == PendingState)
+        {
+            if(budgetExhausted())
+            {
+                if(advanceScan) m_scanFrom = block.blockNumber();
+                return true;
+            }
+            m_forceNext = true;
+            rehighlightBlock(block);
+            m_forceNext = false;
+        }
+        block = block.next();
+    }
+    if(advanceScan) m_scanFrom = INT_MAX; // 之后延后的块会把位置拉回
+    return false;
+}
@@ -0,0 +1,79 @@
+#ifndef SLICEDMARKDOWNHIGHLIGHTER_H
+#define SLICEDMARKDOWNHIGHLIGHTER_H
+/*****************************************************
+*
+* @file     slicedmarkdownhighlighter.h
+* @brief    分片Markdown高亮器，大文档按时间片高亮
+*
+* @description
+*           ==== 核心功能 ====
+*           - 每轮高亮（一次事件处理内的连续highlightBlock）最多运行m_sliceMsec毫秒，
+*             超出后可视范围外的块标记为待高亮，不运行正则规则
+*           - 可视范围内的块总是立即高亮；待高亮的块在空闲时分片处理，可视范围内的优先
+*           - 高亮结果按块内容哈希缓存（所有实例共享）：键由本块、前后块文本和前一块状态组成，
+*             重新打开笔记时直接套用格式，不再运行正则
+*           ==== 使用说明 ====
+*           1. 替换QMarkdownTextEdit默认的MarkdownHighlighter
+*           2. 编辑器滚动或尺寸变化时调用setVisibleBlocks()
+*           ==== 注意 ====
+*           1. 前一块仍待高亮时结果是临时的，不写入缓存；前一块高亮后状态变化会连带重新高亮本块
+*           2. 会修改其他块状态的结果（如Setext标题）不写入缓存
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QCache>
+#include <QElapsedTimer>
+#include <QTextLayout>
+#include <climits>
+#include <markdownhighlighter.h>
+
+class QTimer;
+class SlicedMarkdownHighlighter : public MarkdownHighlighter
+{
+    Q_OBJECT
+public:
+    explicit SlicedMarkdownHighlighter(QTextDocument *parent = nullptr);
+
+    void setVisibleBlocks(int first, int last);
+    void setSliceMsec(int msec) { m_sliceMsec = qMax(1, msec); }
+    bool hasPendingBlocks() const { return m_hasPending; }
+
+protected:
+    void highlightBlock(const QString &text) override;
+
+private:
+    // 待高亮块的状态，MarkdownHighlighter自身的状态都不小于NoState(-1)
+    static constexpr int PendingState = -2;
+
+    struct CachedBlock {
+        QVector<QTextLayout::FormatRange> formats;
+        QVector<InlineRange> ranges;
+        int state = NoState;
+    };
+
+    bool isVisibleBlock(int blockNumber) const;
+    bool budgetExhausted();
+    void deferBlock();
+    QByteArray cacheKey(const QString& text) const;
+    void applyCached(const CachedBlock& cached);
+    CachedBlock *capture(const QString& text) const;
+    void processPending();
+    bool highlightPendingIn(QTextBlock block, int lastBlock, bool advanceScan);
+
+    static QCache<QByteArray, CachedBlock> s_cache;
+
+    QTimer *m_idleTimer = nullptr;
+    QElapsedTimer m_passClock;
+    bool m_inPass = false;
+    bool m_forceNext = false;       // 下一次highlightBlock来自待高亮处理，不再延后
+    bool m_hasPending = false;
+    int m_sliceMsec = 8;
+    int m_firstVisible = 0;
+    int m_lastVisible = 60;         // 尚未收到可视范围时按前几十块处理
+    int m_scanFrom = INT_MAX;       // 此前的块都已高亮，空闲处理从这里继续
+};
+
+#endif // SLICEDMARKDOWNHIGHLIGHTER_H
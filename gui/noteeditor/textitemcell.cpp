@@ -32,13 +32,17 @@ void TextItemCell::initUI()
     m_editor->setPlainText(m_item.content);
     m_editor->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     QObject::connect(m_editor, &TextEdit::textChanged, [=](){
-        m_item.content = m_editor->toPlainText();
-        emit contentChanged(m_item);
+        markDirty();
     });
 
     mainLayout->addWidget(m_editor);
 }
 
+QString TextItemCell::currentContent() const
+{
+    return m_editor->toPlainText();
+}
+
 void TextItemCell::updateContent()
 {
     m_editor->setPlainText(m_item.content);
@@ -18,6 +18,7 @@ private slots:
 private:
     void initUI() override;
     void updateContent() override;
+    QString currentContent() const override;
 
     TextEdit *m_editor;
 };
@@ -4,6 +4,8 @@
 #include <QLabel>
 #include <QVBoxLayout>
 #include <combobox.h>
+#include <imageingestor.h>
+#include <spinbox.h>
 #include <stylemanager.h>
 
 EditorSetPage::EditorSetPage(QWidget *parent) : SettingsPage(parent)
@@ -23,6 +25,10 @@ void EditorSetPage::load(const AppSettings &settings)
     m_wheelSpeedComboBox->setCurrentText(settings.editor.scrollSpeed);
     m_saveOnCloseCheckBox->setChecked(settings.editor.saveOnClose);
     m_autoSaveCheckBox->setChecked(settings.editor.autoSave);
+    m_imageFormatComboBox->setCurrentIndex(settings.editor.imageFormat == "webp" ? 1 : 0);
+    m_pngCompressionSpinBox->setValue(settings.editor.pngCompression);
+    m_pngCompressionSpinBox->setEnabled(m_imageFormatComboBox->currentIndex() == 0);
+    m_imageCacheSpinBox->setValue(settings.editor.imageCacheSize);
 }
 
 void EditorSetPage::save(AppSettings &settings)
@@ -31,6 +37,9 @@ void EditorSetPage::save(AppSettings &settings)
     settings.editor.scrollSpeed = m_wheelSpeedComboBox->currentText();
     settings.editor.saveOnClose = m_saveOnCloseCheckBox->isChecked();
     settings.editor.autoSave = m_autoSaveCheckBox->isChecked();
+    settings.editor.imageFormat = m_imageFormatComboBox->currentIndex() == 1 ? "webp" : "png";
+    settings.editor.pngCompression = m_pngCompressionSpinBox->value();
+    settings.editor.imageCacheSize = m_imageCacheSpinBox->value();
 }
 
 void EditorSetPage::initUI()
@@ -80,6 +89,60 @@ void EditorSetPage::initUI()
     m_autoSaveCheckBox = new QCheckBox("自动保存");
     m_autoSaveCheckBox->setChecked(false); // 默认不选中
 
+    // 图片设置部分
+    QLabel *imageLabel = new QLabel("图片设置");
+    imageLabel->setObjectName("SettingSubtitleLabel");
+
+    QHBoxLayout *imageFormatHLayout = new QHBoxLayout;
+    imageFormatHLayout->setSpacing(10);
+    imageFormatHLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel *imageFormatLabel = new QLabel("粘贴图片存储格式");
+    m_imageFormatComboBox = new ComboBox;
+    m_imageFormatComboBox->addItems({"PNG", "WebP（无损）"});
+    if(!ImageIngestor::isWebpSupported())
+    {
+        m_imageFormatComboBox->setToolTip("未找到WebP图片插件，将以PNG存储");
+    }
+
+    imageFormatHLayout->addWidget(imageFormatLabel);
+    imageFormatHLayout->addWidget(m_imageFormatComboBox);
+    imageFormatHLayout->addStretch();
+
+    QHBoxLayout *pngCompressionHLayout = new QHBoxLayout;
+    pngCompressionHLayout->setSpacing(10);
+    pngCompressionHLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel *pngCompressionLabel = new QLabel("PNG压缩级别");
+    m_pngCompressionSpinBox = new SpinBox;
+    m_pngCompressionSpinBox->setRange(0, 9);
+    m_pngCompressionSpinBox->setValue(6);
+    m_pngCompressionSpinBox->setToolTip("级别越高文件越小，入库越慢");
+
+    pngCompressionHLayout->addWidget(pngCompressionLabel);
+    pngCompressionHLayout->addWidget(m_pngCompressionSpinBox);
+    pngCompressionHLayout->addStretch();
+
+    QHBoxLayout *imageCacheHLayout = new QHBoxLayout;
+    imageCacheHLayout->setSpacing(10);
+    imageCacheHLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel *imageCacheLabel = new QLabel("图片内存缓存");
+    m_imageCacheSpinBox = new SpinBox;
+    m_imageCacheSpinBox->setRange(8, 1024);
+    m_imageCacheSpinBox->setSuffix(" MB");
+    m_imageCacheSpinBox->setValue(64);
+    m_imageCacheSpinBox->setToolTip("笔记图片、动画帧和缩略图共用，超出后淘汰最久未使用的");
+
+    imageCacheHLayout->addWidget(imageCacheLabel);
+    imageCacheHLayout->addWidget(m_imageCacheSpinBox);
+    imageCacheHLayout->addStretch();
+
+    // WebP为无损编码，不使用PNG压缩级别
+    QObject::connect(m_imageFormatComboBox, QOverload<int>::of(&ComboBox::currentIndexChanged), [=](int index){
+        m_pngCompressionSpinBox->setEnabled(index == 0);
+    });
+
     // 添加到主布局
     mainVLayout->addWidget(titleLabel);
     mainVLayout->addSpacing(20);
@@ -90,6 +153,11 @@ void EditorSetPage::initUI()
     mainVLayout->addWidget(saveLabel);
     mainVLayout->addWidget(m_saveOnCloseCheckBox);
     mainVLayout->addWidget(m_autoSaveCheckBox);
+    mainVLayout->addSpacing(20);
+    mainVLayout->addWidget(imageLabel);
+    mainVLayout->addLayout(imageFormatHLayout);
+    mainVLayout->addLayout(pngCompressionHLayout);
+    mainVLayout->addLayout(imageCacheHLayout);
     mainVLayout->addStretch();
 
 
@@ -14,6 +14,9 @@
 *           	2. 滚轮速度：下拉框选择
 *           	3. 关闭后直接保存：复选框控制
 *           	4. 自动保存：复选框控制（选择后，关闭后直接保存置灰）
+*           	5. 图片存储格式：下拉框选择PNG或无损WebP
+*           	6. PNG压缩级别：数字框0~9（选择WebP时置灰）
+*           	7. 图片内存缓存：数字框（MB），所有图片控件共用
 *           ==== 使用说明 ====
 *           ==== 注意 ====
 *
@@ -25,6 +28,7 @@
 
 class ComboBox;
 class QCheckBox;
+class SpinBox;
 class EditorSetPage : public SettingsPage
 {
     Q_OBJECT
@@ -46,6 +50,9 @@ private:
     ComboBox *m_wheelSpeedComboBox;
     QCheckBox *m_saveOnCloseCheckBox;
     QCheckBox *m_autoSaveCheckBox;
+    ComboBox *m_imageFormatComboBox;
+    SpinBox *m_pngCompressionSpinBox;
+    SpinBox *m_imageCacheSpinBox;
 
 };
 
@@ -1,12 +1,20 @@
 #include "exportsetpage.h"
+#include "exportmanager.h"
 
+#include <QCheckBox>
+#include <QFileDialog>
 #include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
 #include <QVBoxLayout>
+#include <combobox.h>
+#include <spinbox.h>
 #include <stylemanager.h>
 
 ExportSetPage::ExportSetPage(QWidget *parent) : SettingsPage(parent)
 {
     initUI();
+    initConnections();
 }
 
 QString ExportSetPage::title() const
@@ -14,14 +22,20 @@ QString ExportSetPage::title() const
     return "导出";
 }
 
-void ExportSetPage::load(const AppSettings &)
+void ExportSetPage::load(const AppSettings &settings)
 {
-
+    m_formatComboBox->setCurrentIndex(settings.exportSet.format == "archive" ? 1 : 0);
+    m_outputDirEdit->setText(settings.exportSet.outputDir);
+    m_incrementalCheckBox->setChecked(settings.exportSet.incremental);
+    m_threadCountSpinBox->setValue(settings.exportSet.threadCount);
 }
 
-void ExportSetPage::save(AppSettings &)
+void ExportSetPage::save(AppSettings &settings)
 {
-
+    settings.exportSet.format = m_formatComboBox->currentIndex() == 1 ? "archive" : "html";
+    settings.exportSet.outputDir = m_outputDirEdit->text().trimmed();
+    settings.exportSet.incremental = m_incrementalCheckBox->isChecked();
+    settings.exportSet.threadCount = m_threadCountSpinBox->value();
 }
 
 void ExportSetPage::initUI()
@@ -39,11 +53,126 @@ void ExportSetPage::initUI()
     titleLabel->setObjectName("SettingTitleLabel");
 
     // 格式设置部分
-    QLabel *label = new QLabel("当前版本未实现");
-    label->setObjectName("SettingSubtitleLabel");
+    QLabel *formatLabel = new QLabel("格式设置");
+    formatLabel->setObjectName("SettingSubtitleLabel");
+
+    QHBoxLayout *formatHLayout = new QHBoxLayout;
+    formatHLayout->setSpacing(10);
+    formatHLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel *formatSelectLabel = new QLabel("导出格式");
+    m_formatComboBox = new ComboBox;
+    m_formatComboBox->addItems({"静态站点(HTML)", "单个归档(tar)"});
+
+    formatHLayout->addWidget(formatSelectLabel);
+    formatHLayout->addWidget(m_formatComboBox);
+    formatHLayout->addStretch();
+
+    // 导出目录
+    QHBoxLayout *outputHLayout = new QHBoxLayout;
+    outputHLayout->setSpacing(10);
+    outputHLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel *outputLabel = new QLabel("导出目录");
+    m_outputDirEdit = new QLineEdit;
+    m_outputDirEdit->setFixedWidth(300);
+    m_outputDirEdit->setPlaceholderText("选择导出目录");
+    m_browseButton = new QPushButton("浏览");
+    m_browseButton->setFixedWidth(100);
+
+    outputHLayout->addWidget(outputLabel);
+    outputHLayout->addWidget(m_outputDirEdit);
+    outputHLayout->addWidget(m_browseButton);
+    outputHLayout->addStretch();
+
+    // 性能设置部分
+    QLabel *performanceLabel = new QLabel("性能设置");
+    performanceLabel->setObjectName("SettingSubtitleLabel");
+
+    m_incrementalCheckBox = new QCheckBox("增量导出（跳过未修改的笔记）");
+    m_incrementalCheckBox->setChecked(true); // 默认选中
+
+    QHBoxLayout *threadHLayout = new QHBoxLayout;
+    threadHLayout->setSpacing(10);
+    threadHLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel *threadLabel = new QLabel("导出线程数");
+    m_threadCountSpinBox = new SpinBox;
+    m_threadCountSpinBox->setRange(0, 64);
+    m_threadCountSpinBox->setSpecialValueText("自动");
+
+    threadHLayout->addWidget(threadLabel);
+    threadHLayout->addWidget(m_threadCountSpinBox);
+    threadHLayout->addStretch();
+
+    // 执行导出部分
+    QHBoxLayout *exportHLayout = new QHBoxLayout;
+    exportHLayout->setSpacing(10);
+    exportHLayout->setContentsMargins(0, 0, 0, 0);
+
+    m_exportButton = new QPushButton("立即导出");
+    m_exportButton->setFixedWidth(100);
+    m_statusLabel = new QLabel;
+
+    exportHLayout->addWidget(m_exportButton);
+    exportHLayout->addWidget(m_statusLabel);
+    exportHLayout->addStretch();
 
     mainVLayout->addWidget(titleLabel);
     mainVLayout->addSpacing(20);
-    mainVLayout->addWidget(label);
+    mainVLayout->addWidget(formatLabel);
+    mainVLayout->addLayout(formatHLayout);
+    mainVLayout->addLayout(outputHLayout);
+    mainVLayout->addSpacing(20);
+    mainVLayout->addWidget(performanceLabel);
+    mainVLayout->addWidget(m_incrementalCheckBox);
+    mainVLayout->addLayout(threadHLayout);
+    mainVLayout->addSpacing(20);
+    mainVLayout->addLayout(exportHLayout);
     mainVLayout->addStretch();
 }
+
+void ExportSetPage::initConnections()
+{
+    ExportManager *exportManager = ExportManager::getExportManager();
+
+    QObject::connect(m_browseButton, &QPushButton::clicked, [=](){
+        QString dir = QFileDialog::getExistingDirectory(this, "选择导出目录", m_outputDirEdit->text());
+        if(!dir.isEmpty()) m_outputDirEdit->setText(dir);
+    });
+
+    QObject::connect(m_exportButton, &QPushButton::clicked, [=](){
+        AppSettings settings;
+        save(settings);
+        if(settings.exportSet.outputDir.isEmpty())
+        {
+            m_statusLabel->setText("请先选择导出目录");
+            return;
+        }
+        if(exportManager->startExport(settings.exportSet))
+        {
+            m_exportButton->setEnabled(false);
+            m_statusLabel->setText("正在导出...");
+        }
+        else m_statusLabel->setText("导出失败，请检查导出目录");
+    });
+
+    QObject::connect(exportManager, &ExportManager::exportProgress, this, [=](int done, int total){
+        m_statusLabel->setText(QString("正在导出 %1/%2").arg(done).arg(total));
+    });
+
+    QObject::connect(exportManager, &ExportManager::exportFinished, this,
+                     [=](bool success, const ExportStats &stats){
+        m_exportButton->setEnabled(true);
+        m_statusLabel->setText(QString("%1：共%2个，更新%3个，跳过%4个，失败%5个，用时%6毫秒")
+                               .arg(success ? "导出完成" : "导出未全部完成")
+                               .arg(stats.total).arg(stats.rendered).arg(stats.skipped)
+                               .arg(stats.failed).arg(stats.elapsedMs));
+    });
+
+    if(exportManager->isRunning())
+    {
+        m_exportButton->setEnabled(false);
+        m_statusLabel->setText("正在导出...");
+    }
+}
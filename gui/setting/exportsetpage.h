@@ -10,9 +10,14 @@
 *           ==== 布局 ====
 *           ==== 核心功能 ====
 *           5. 导出
-*           	1. 当前版本未实现
+*           	1. 导出格式：下拉框选择（静态站点 / 单个归档）
+*           	2. 导出目录：输入框 + 浏览按钮
+*           	3. 增量导出：复选框控制
+*           	4. 导出线程数：数值框（0为自动）
+*           	5. 立即导出：按钮，进度显示在状态标签中
 *           ==== 使用说明 ====
 *           ==== 注意 ====
+*           导出在后台执行，关闭设置对话框不会中断导出
 *
 * @author   无声目
 * @date     2025/09/23
@@ -20,6 +25,12 @@
 *****************************************************/
 #include "settingspage.h"
 
+class ComboBox;
+class SpinBox;
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
 class ExportSetPage : public SettingsPage
 {
     Q_OBJECT
@@ -35,7 +46,15 @@ signals:
 
 private:
     void initUI() override;
-
+    void initConnections();
+
+    ComboBox *m_formatComboBox;
+    QLineEdit *m_outputDirEdit;
+    QPushButton *m_browseButton;
+    QCheckBox *m_incrementalCheckBox;
+    SpinBox *m_threadCountSpinBox;
+    QPushButton *m_exportButton;
+    QLabel *m_statusLabel;
 };
 
 #endif // EXPORTSETPAGE_H
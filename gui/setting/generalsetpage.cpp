@@ -1,13 +1,18 @@
 #include "generalsetpage.h"
 #include "shortcutsdialog.h"
+#include "databasemanager.h"
+#include "projectmanager.h"
+#include "metactk.h"
 
 #include <QCheckBox>
+#include <QFutureWatcher>
 #include <QHeaderView>
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QTableWidget>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 #include <combobox.h>
 #include <stylemanager.h>
 
@@ -26,6 +31,7 @@ void GeneralSetPage::load(const AppSettings &settings)
     m_languageComboBox->setCurrentText(settings.general.language);
     m_logEnableCheckBox->setChecked(settings.general.enableLogging);
     m_logLevelComboBox->setCurrentText(settings.general.logLevel);
+    m_storageFormatComboBox->setCurrentIndex(settings.general.storageFormat == "cbor" ? 1 : 0);
 }
 
 void GeneralSetPage::save(AppSettings &settings)
@@ -33,6 +39,7 @@ void GeneralSetPage::save(AppSettings &settings)
     settings.general.language = m_languageComboBox->currentText();
     settings.general.enableLogging = m_logEnableCheckBox->isChecked();
     settings.general.logLevel = m_logLevelComboBox->currentText();
+    settings.general.storageFormat = m_storageFormatComboBox->currentIndex() == 1 ? "cbor" : "json";
 }
 
 void GeneralSetPage::initUI()
@@ -154,6 +161,67 @@ void GeneralSetPage::initUI()
     logLevelHLayout->addWidget(m_logLevelComboBox);
     logLevelHLayout->addStretch();
 
+    // 配置文件存储格式
+    QHBoxLayout *storageHLayout = new QHBoxLayout;
+    storageHLayout->setSpacing(10);
+    storageHLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLabel *storageFormatLabel = new QLabel("存储格式");
+    m_storageFormatComboBox = new ComboBox;
+    m_storageFormatComboBox->addItems({"JSON(文本)", "CBOR(二进制)"});
+    m_migrateButton = new QPushButton("迁移代码库");
+    m_benchmarkButton = new QPushButton("格式基准测试");
+    m_storageStatusLabel = new QLabel;
+
+    storageHLayout->addWidget(storageFormatLabel);
+    storageHLayout->addWidget(m_storageFormatComboBox);
+    storageHLayout->addWidget(m_migrateButton);
+    storageHLayout->addWidget(m_benchmarkButton);
+    storageHLayout->addStretch();
+
+    // 迁移：将已有meta.ctk转换为当前选择的格式
+    QObject::connect(m_migrateButton, &QPushButton::clicked, [=](){
+        QString rootPath = DatabaseManager::getDatabaseManager()->rootPath();
+        MetaCtk::StorageFormat format = m_storageFormatComboBox->currentIndex() == 1
+                ? MetaCtk::StorageFormat::Cbor : MetaCtk::StorageFormat::Json;
+        m_migrateButton->setEnabled(false);
+        m_storageStatusLabel->setText("正在迁移...");
+        ProjectManager::getProjectManager()->setCachedFormat(format);
+
+        QFutureWatcher<int> *watcher = new QFutureWatcher<int>(this);
+        QObject::connect(watcher, &QFutureWatcher<int>::finished, this, [=](){
+            m_migrateButton->setEnabled(true);
+            m_storageStatusLabel->setText(QString("迁移完成，共转换%1个文件").arg(watcher->result()));
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run([=](){
+            return MetaCtk::migrateRepository(rootPath, format);
+        }));
+    });
+
+    // 基准测试：对比两种格式的文件大小和完整解析耗时
+    QObject::connect(m_benchmarkButton, &QPushButton::clicked, [=](){
+        QString rootPath = DatabaseManager::getDatabaseManager()->rootPath();
+        m_benchmarkButton->setEnabled(false);
+        m_storageStatusLabel->setText("正在测试...");
+
+        QFutureWatcher<MetaCtk::FormatBenchmark> *watcher = new QFutureWatcher<MetaCtk::FormatBenchmark>(this);
+        QObject::connect(watcher, &QFutureWatcher<MetaCtk::FormatBenchmark>::finished, this, [=](){
+            MetaCtk::FormatBenchmark result = watcher->result();
+            m_benchmarkButton->setEnabled(true);
+            m_storageStatusLabel->setText(QString("%1个文件  JSON：%2KB，解析%3毫秒  CBOR：%4KB，解析%5毫秒")
+                                          .arg(result.files)
+                                          .arg(result.jsonBytes / 1024.0, 0, 'f', 1)
+                                          .arg(result.jsonParseNs / 1e6, 0, 'f', 2)
+                                          .arg(result.cborBytes / 1024.0, 0, 'f', 1)
+                                          .arg(result.cborParseNs / 1e6, 0, 'f', 2));
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run([=](){
+            return MetaCtk::benchmarkRepository(rootPath);
+        }));
+    });
+
     mainVLayout->addWidget(titleLabel);
     mainVLayout->addSpacing(20);
     mainVLayout->addWidget(languageLabel);
@@ -168,6 +236,8 @@ void GeneralSetPage::initUI()
     mainVLayout->addWidget(developerLabel);
     mainVLayout->addWidget(m_logEnableCheckBox);
     mainVLayout->addLayout(logLevelHLayout);
+    mainVLayout->addLayout(storageHLayout);
+    mainVLayout->addWidget(m_storageStatusLabel);
     mainVLayout->addStretch();
 }
 
@@ -189,4 +259,8 @@ void GeneralSetPage::initConnections()
     QObject::connect(m_logLevelComboBox, &ComboBox::currentTextChanged, [=](const QString& text){
         emit settingChanged("general", "logLevel", text);
     });
+
+    QObject::connect(m_storageFormatComboBox, QOverload<int>::of(&ComboBox::currentIndexChanged), [=](int index){
+        emit settingChanged("general", "storageFormat", QString(index == 1 ? "cbor" : "json"));
+    });
 }
@@ -17,6 +17,7 @@
 *           	4. 开发者设置
 *           		1. 日志开关
 *           		2. 日志等级
+*           		3. 存储格式：meta.ctk使用json或CBOR，迁移代码库、格式基准测试按钮（后台执行）
 *           ==== 使用说明 ====
 *           ==== 注意 ====
 *
@@ -30,6 +31,7 @@ class Dialog;
 class ComboBox;
 class QCheckBox;
 class QPushButton;
+class QLabel;
 class GeneralSetPage : public SettingsPage
 {
     Q_OBJECT
@@ -51,6 +53,10 @@ private:
     QPushButton *m_checkUpdateButton;
     QCheckBox *m_logEnableCheckBox;
     ComboBox *m_logLevelComboBox;
+    ComboBox *m_storageFormatComboBox;
+    QPushButton *m_migrateButton;
+    QPushButton *m_benchmarkButton;
+    QLabel *m_storageStatusLabel;
 };
 
 #endif // GENERALSETPAGE_H
@@ -30,12 +30,13 @@ void DynamicNoteTab::initUI()
     setupToolBar();
 
     m_scrollVLayout->insertWidget(1, m_noteWidget);
+    m_noteWidget->setScrollArea(m_scrollArea); // 单元格按滚动位置创建
     m_scrollVLayout->addStretch(1);
 
     m_mainVLayout->insertLayout(0, m_addToolBar);
 
-    QObject::connect(m_noteWidget, &NoteEditor::noteItemsChanged, [=](const QList<NoteItem> &items){
-        m_codeNote.note = items;
+    // 编辑时只标记未保存，内容在syncContent中取出
+    QObject::connect(m_noteWidget, &NoteEditor::contentEdited, [=](){
         m_isSaved = false;
         emit savedChanged(false);
     });
@@ -47,6 +48,17 @@ void DynamicNoteTab::updateContent()
     m_noteWidget->setNoteItems(m_codeNote.note);
 }
 
+void DynamicNoteTab::syncContent()
+{
+    m_noteWidget->syncItems(m_codeNote.note);
+}
+
+// 未创建的槽位内容已在NoteEditor中，不需要写出
+QList<ItemCell*> DynamicNoteTab::itemCells() const
+{
+    return m_noteWidget->cells();
+}
+
 void DynamicNoteTab::setupToolBar()
 {
     // 四个添加按钮：纯文本，图片，markdown，代码
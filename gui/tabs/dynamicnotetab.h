@@ -18,6 +18,8 @@ signals:
 private:
     void initUI();
     void updateContent() override;
+    void syncContent() override;
+    QList<ItemCell*> itemCells() const override;
     void setupToolBar();
 
     QHBoxLayout *m_addToolBar;
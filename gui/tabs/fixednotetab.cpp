@@ -44,7 +44,7 @@ void FixedNoteTab::restoreNormal()
     // 保存最大化项的内容
     if(m_maximizedItemCell)
     {
-        NoteItem itemCell = m_maximizedItemCell->item();
+        NoteItem itemCell = m_maximizedItemCell->snapshotItem();
         if(m_currentMode == ImageMaximized)
         {
             m_imageItemCell->setItem(itemCell);
@@ -70,16 +70,27 @@ void FixedNoteTab::restoreNormal()
 
 void FixedNoteTab::onContentChanged()
 {
-    // 更新固定布局的内容到m_codeNote
-    m_codeNote.note.clear();
-
-    m_codeNote.note.append(m_imageItemCell->item());
-    m_codeNote.note.append(m_codeItemCell->item());
-
+    // 只标记未保存，内容在syncContent中取出
     m_isSaved = false;
     emit savedChanged(false);
 }
 
+void FixedNoteTab::syncContent()
+{
+    // 更新固定布局的内容到m_codeNote，最大化时以最大化项为准
+    const QList<ItemCell*> cells = itemCells();
+    m_codeNote.note.clear();
+    m_codeNote.note.append(cells[0]->item());
+    m_codeNote.note.append(cells[1]->item());
+}
+
+QList<ItemCell*> FixedNoteTab::itemCells() const
+{
+    ItemCell *imageCell = m_currentMode == ImageMaximized && m_maximizedItemCell ? m_maximizedItemCell : m_imageItemCell;
+    ItemCell *codeCell = m_currentMode == CodeMaximized && m_maximizedItemCell ? m_maximizedItemCell : m_codeItemCell;
+    return {imageCell, codeCell};
+}
+
 void FixedNoteTab::initUI()
 {
     setupImageItem();
@@ -214,7 +225,7 @@ void FixedNoteTab::switchToMaximizedView(ItemCell *itemCell)
     QObject::connect(m_restoreButton, &QToolButton::clicked, this, &FixedNoteTab::restoreNormal);
 
     // 创建新的最大化项目（复制内容）
-    NoteItem itemData = itemCell->item();
+    NoteItem itemData = itemCell->snapshotItem();
     if(m_currentMode == ImageMaximized) m_maximizedItemCell = new ImageItemCell(itemData, this);
     else m_maximizedItemCell = new CodeItemCell(itemData, this);
 
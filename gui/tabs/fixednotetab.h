@@ -26,6 +26,8 @@ private slots:
 private:
     void initUI();
     void updateContent() override;
+    void syncContent() override;
+    QList<ItemCell*> itemCells() const override;
     void setupImageItem();
     void setupCodeItem();
     void switchToMaximizedView(ItemCell *itemToMaximize);
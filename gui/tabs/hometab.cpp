@@ -3,7 +3,7 @@
 
 #include <QFrame>
 #include <QLabel>
-#include <QListWidget>
+#include <QListView>
 #include <QVBoxLayout>
 #include <QDebug>
 #include <databasemanager.h>
@@ -11,7 +11,8 @@
 #include <projectmanager.h>
 #include <QPropertyAnimation>
 #include <rotationbutton.h>
-#include <imagelabel.h>
+#include <recentprojectmodel.h>
+#include <recentprojectdelegate.h>
 
 HomeTab::HomeTab(QWidget *parent) : QFrame(parent)
 {
@@ -27,9 +28,9 @@ HomeTab::HomeTab(QWidget *parent) : QFrame(parent)
     qInfo() << "HomeTab initialized successfully";
 }
 
-void HomeTab::onProjectItemClicked(QListWidgetItem *item)
+void HomeTab::onProjectItemClicked(const QModelIndex &index)
 {
-    QString projectPath = item->data(Qt::UserRole).toString();
+    QString projectPath = index.data(RecentProjectModel::PathRole).toString();
     if(!projectPath.isEmpty()) emit projectItemClicked(projectPath);
 }
 
@@ -80,23 +81,28 @@ void HomeTab::initUI()
     headerLayout->addStretch();
     headerLayout->addWidget(refreshButton);
 
-    // 项目列表
-    m_projectList = new QListWidget;
+    // 项目列表：模型 + 绘制代理，不为每行创建控件
+    m_projectModel = new RecentProjectModel(this);
+    m_projectList = new QListView;
     m_projectList->setObjectName("projectList");
+    m_projectList->setModel(m_projectModel);
+    m_projectList->setItemDelegate(new RecentProjectDelegate(m_projectList));
+    m_projectList->setUniformItemSizes(true);
     m_projectList->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     m_projectList->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
     m_projectList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     m_projectList->setFocusPolicy(Qt::NoFocus);
+    m_projectList->setMouseTracking(true); // 悬停效果
 
-    m_projectList->setResizeMode(QListWidget::Adjust);
-    m_projectList->setMovement(QListWidget::Static);
+    m_projectList->setResizeMode(QListView::Adjust);
+    m_projectList->setMovement(QListView::Static);
 
     // 添加示例项目
     recentLayout->addLayout(headerLayout);
     recentLayout->addWidget(m_projectList, 1);
     homeLayout->addWidget(recentGroup, 1);
 
-    QObject::connect(m_projectList, &QListWidget::itemClicked, this, &HomeTab::onProjectItemClicked);
+    QObject::connect(m_projectList, &QListView::clicked, this, &HomeTab::onProjectItemClicked);
 
     // 加载最近项目
     loadRecentProjects();
@@ -104,120 +110,50 @@ void HomeTab::initUI()
 
 void HomeTab::loadRecentProjects()
 {
-    m_projectList->clear();
-
     // 从数据库获取所有项目
     DatabaseManager *db = DatabaseManager::getDatabaseManager();
     QVector<Note> allNotes = db->allNotes();
 
-    // 按修改时间排序（最近修改的在前）
-    std::sort(allNotes.begin(), allNotes.end(), [](const Note &a, const Note &b){
-        Node nodeA = DatabaseManager::getDatabaseManager()->node(a.nodeId);
-        Node nodeB = DatabaseManager::getDatabaseManager()->node(b.nodeId);
-        return nodeA.modified > nodeB.modified;
+    // 每个项目只查询一次节点，再按修改时间排序（最近修改的在前）
+    QVector<QPair<Note, Node>> entries;
+    entries.reserve(allNotes.size());
+    for(const Note &note : allNotes) entries.append(qMakePair(note, db->node(note.nodeId)));
+    std::sort(entries.begin(), entries.end(), [](const QPair<Note, Node> &a, const QPair<Note, Node> &b){
+        return a.second.modified > b.second.modified;
     });
 
-    // 只显示最近15个项目
-    int count = qMin(15, allNotes.size());
+    // 只显示最近m_recentLimit个项目
+    int count = qMin(m_recentLimit, entries.size());
+    QVector<RecentProject> projects;
+    projects.reserve(count);
+    QHash<int, QString> parentNames;
     for(int i = 0; i < count; i++)
     {
-        const Note &note = allNotes[i];
-        Node node = db->node(note.nodeId);
-
+        const Note &note = entries[i].first;
+        const Node &node = entries[i].second;
+
+        RecentProject project;
+        project.nodeId = note.nodeId;
+        project.name = note.projectName;
+        project.imagePath = note.imagePath;
+        project.modified = node.modified;
         // 获取项目完整路径
-        QString projectPath = db->getNodeFullPath(note.nodeId);
+        project.path = db->getNodeFullPath(note.nodeId);
 
         // 获取父节点名称
-        QString parentName = "根目录";
+        project.parentName = "根目录";
         if(node.parentId > 0)
         {
-            Node parentNode = db->node(node.parentId);
-            if(parentNode.id > 0) parentName = parentNode.name;
+            if(!parentNames.contains(node.parentId))
+            {
+                Node parentNode = db->node(node.parentId);
+                parentNames.insert(node.parentId, parentNode.id > 0 ? parentNode.name : project.parentName);
+            }
+            project.parentName = parentNames.value(node.parentId);
         }
-
-        addProjectItem(note.projectName, note.imagePath, note.nodeId, projectPath, parentName, node.modified);
+        projects.append(project);
     }
 
-    // 如果没有项目，显示提示信息
-    if(m_projectList->count() == 0)
-    {
-        QListWidgetItem *emptyItem = new QListWidgetItem("暂无项目");
-        emptyItem->setTextAlignment(Qt::AlignCenter);
-        emptyItem->setFlags(Qt::NoItemFlags); // 不可点击
-        m_projectList->addItem(emptyItem);
-    }
-}
-
-void HomeTab::addProjectItem(const QString &projectName, const QString &imagePath,
-                             int nodeId, const QString &projectPath,
-                             const QString &parentName, const QDateTime &modifiedTime)
-{
-    QListWidgetItem *item = new QListWidgetItem(m_projectList);
-    item->setData(Qt::UserRole, projectPath); // 存储项目路径
-
-    QWidget *widget = new QWidget;
-    QHBoxLayout *hLayout = new QHBoxLayout(widget);
-    hLayout->setSpacing(12);
-    hLayout->setContentsMargins(10, 8, 10, 8);
-
-    // 左侧图片
-    ImageLabel *imageLabel = new ImageLabel;
-    imageLabel->setObjectName("projectImage");
-
-    QPixmap pixmap;
-    if(!imagePath.isEmpty() && QFile::exists(imagePath)) pixmap = QPixmap(imagePath);
-
-    if(!pixmap.isNull())
-    {
-        // 缩放图片以适应标签大小
-        pixmap = pixmap.scaled(40, 40, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        imageLabel->setPixmap(pixmap);
-    }
-
-    // 右侧信息区域
-    QWidget *infoWidget = new QWidget;
-    QVBoxLayout *infoLayout = new QVBoxLayout(infoWidget);
-    infoLayout->setContentsMargins(0, 0, 0, 0);
-    infoLayout->setSpacing(4);
-
-    // 项目名
-    QLabel *nameLabel = new QLabel(projectName);
-    nameLabel->setObjectName("projectName");
-
-    // 修改日期
-    QString modifiedText = modifiedTime.toString("yyyy-MM-dd");
-    QLabel *modifiedLabel = new QLabel(modifiedText);
-    modifiedLabel->setObjectName("projectModified");
-
-    // 父节点名称
-    QLabel *parentLabel = new QLabel(parentName);
-    parentLabel->setObjectName("projectParent");
-
-    // NodeId（右下角，小字）
-    QLabel *idLabel = new QLabel(QString("ID: %1").arg(nodeId));
-    idLabel->setObjectName("projectId");
-
-    // 底部信息区域（NodeId和间距）
-    QWidget *bottomWidget = new QWidget;
-    QHBoxLayout *bottomLayout = new QHBoxLayout(bottomWidget);
-    bottomLayout->setContentsMargins(0, 0, 0, 0);
-    bottomLayout->setSpacing(0);
-
-    bottomLayout->addWidget(modifiedLabel);
-    bottomLayout->addStretch();
-    bottomLayout->addWidget(parentLabel);
-    bottomLayout->addSpacing(5);
-    bottomLayout->addWidget(idLabel);
-
-    infoLayout->addWidget(nameLabel);
-    infoLayout->addStretch();
-    infoLayout->addWidget(bottomWidget);
-
-    hLayout->addWidget(imageLabel);
-    hLayout->addWidget(infoWidget, 1);
-
-    widget->setLayout(hLayout);
-    item->setSizeHint(widget->sizeHint());
-
-    m_projectList->setItemWidget(item, widget);
+    // 没有项目时模型显示"暂无项目"
+    m_projectModel->setProjects(projects);
 }
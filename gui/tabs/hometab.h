@@ -8,6 +8,7 @@
 * @description
 *           ==== 布局 ====
 *           ==== 核心功能 ====
+*           最近项目列表为QListView + RecentProjectModel + RecentProjectDelegate，行由代理直接绘制
 *           ==== 使用说明 ====
 *           ==== 注意 ====
 *
@@ -18,8 +19,9 @@
 
 #include <QFrame>
 
-class QListWidget;
-class QListWidgetItem;
+class QListView;
+class QModelIndex;
+class RecentProjectModel;
 class HomeTab : public QFrame
 {
     Q_OBJECT
@@ -33,16 +35,16 @@ signals:
 protected:
 
 private slots:
-    void onProjectItemClicked(QListWidgetItem *item);
+    void onProjectItemClicked(const QModelIndex &index);
     void onProjectListChanged();
 
 private:
     void initUI();
     void loadRecentProjects();
-    void addProjectItem(const QString &projectName, const QString &imagePath, int nodeId,
-                        const QString &projectPath, const QString &parentName, const QDateTime &modifiedTime);
 
-    QListWidget *m_projectList;
+    QListView *m_projectList;
+    RecentProjectModel *m_projectModel;
+    int m_recentLimit = 15; // 最近项目显示数量
 };
 
 #endif // HOMETAB_H
@@ -1,19 +1,26 @@
 #include "noteeditor.h"
+#include "itemcell.h"
 #include "notetab.h"
 #include "tagswidget.h"
 #include "projectmanager.h"
 #include "databasemanager.h"
 #include "popoverwidget.h"
 #include "stylemanager.h"
+#include "autosavemanager.h"
+#include "historymanager.h"
+#include "historydialog.h"
+#include "savequeue.h"
 
 #include <QScrollArea>
 #include <QScrollBar>
 #include <QVBoxLayout>
 #include <QResizeEvent>
 #include <QDebug>
+#include <QMessageBox>
 #include <QAction>
 #include <QToolButton>
 #include <QStackedLayout>
+#include <QTimer>
 
 NoteTab::NoteTab(const QString &configPath, QWidget *parent)
     : QWidget(parent),
@@ -28,16 +35,42 @@ NoteTab::NoteTab(const QString &configPath, QWidget *parent)
     });
 
     if(!m_configPath.isEmpty())
-        m_metaCtk = ProjectManager::getProjectManager()->getMetaCtk(m_configPath);
+        m_metaCtk = ProjectManager::getProjectManager()->acquireMetaCtk(m_configPath);
 
     initNoteTabUI();
 
+    // 自动保存：编辑后防抖追加日志，一段时间后或日志过大时保存
+    AutoSaveManager *autoSaveManager = AutoSaveManager::getAutoSaveManager();
+    m_journalTimer = new QTimer(this);
+    m_journalTimer->setSingleShot(true);
+    m_journalTimer->setInterval(autoSaveManager->journalInterval());
+    QObject::connect(m_journalTimer, &QTimer::timeout, this, &NoteTab::flushJournal);
+
+    m_compactTimer = new QTimer(this);
+    m_compactTimer->setSingleShot(true);
+    m_compactTimer->setInterval(autoSaveManager->compactInterval());
+    QObject::connect(m_compactTimer, &QTimer::timeout, this, &NoteTab::save);
+
+    QObject::connect(this, &NoteTab::savedChanged, [=](bool isSaved){
+        if(isSaved) return;
+        m_editSerial++;
+        onContentEdited();
+    });
+    // 后台保存的结果
+    QObject::connect(SaveQueue::getSaveQueue(), &SaveQueue::saveFinished, this, &NoteTab::onSaveFinished);
+
     // 创建动作并设置快捷键
     QAction *action = new QAction("save", this);
     action->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_S));
     // 连接动作的triggered信号到槽函数
     QObject::connect(action, &QAction::triggered, this, &NoteTab::save);
     addAction(action);
+
+    // 历史版本（CTRL+SHIFT+H唤起）
+    QAction *historyAction = new QAction("history", this);
+    historyAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_H));
+    QObject::connect(historyAction, &QAction::triggered, this, &NoteTab::showHistory);
+    addAction(historyAction);
 }
 
 QString NoteTab::configPath() const {return m_configPath;}
@@ -52,6 +85,12 @@ void NoteTab::load()
         return;
     }
     m_codeNote = m_metaCtk->noteContent();
+    if(m_metaCtk->noteContentLoadFailed())
+    {
+        QMessageBox::warning(this, "错误", "笔记内容读取失败，为避免覆盖原文件，本笔记的修改将无法保存");
+    }
+    m_journal.setConfigPath(m_metaCtk->configPath());
+    m_journaledNote = m_codeNote;
     m_isSaved = true;
     emit savedChanged(true);
 }
@@ -59,16 +98,155 @@ void NoteTab::load()
 void NoteTab::save()
 {
     if(m_isSaved) return;
+    m_journalTimer->stop();
+    m_compactTimer->stop();
+    // 大内容先在后台入库，完成后再次保存
+    if(storePendingContent()) return;
+    syncContent();
     m_metaCtk->setNoteContent(m_codeNote);
-    m_metaCtk->save();
+    // 后台写入，不阻塞界面
+    if(!m_metaCtk->saveAsync())
+    {
+        QMessageBox::warning(this, "错误", "笔记保存失败，修改仍保留在编辑器中");
+        return;
+    }
+    // 当前日志中的记录都已包含在本次保存中，写入成功后丢弃
+    AutoSaveManager::getAutoSaveManager()->compactStarted(m_metaCtk->configPath(), m_journal.size(),
+                                                          m_metaCtk->saveTicket());
+    if(m_savingTicket == 0) m_savingBase = m_journaledNote;
+    m_journaledNote = m_codeNote;
+    m_savingNote = m_codeNote;
+    m_savingSerial = m_editSerial;
+    m_savingTicket = m_metaCtk->saveTicket();
+}
+
+// 同步写入，成功后丢弃全部编辑日志
+bool NoteTab::saveNow()
+{
+    if(m_isSaved) return true;
+    m_journalTimer->stop();
+    m_compactTimer->stop();
+    for(ItemCell *cell : itemCells())
+    {
+        if(cell->hasPendingContent()) cell->storePendingContentNow();
+    }
+    syncContent();
+    m_metaCtk->setNoteContent(m_codeNote);
+    m_savingSerial = m_editSerial;
+    if(!m_metaCtk->save())
+    {
+        QMessageBox::warning(this, "错误", "笔记保存失败，修改仍保留在编辑器中");
+        return false;
+    }
+    m_savingTicket = 0;
+    AutoSaveManager::getAutoSaveManager()->discardJournal(m_metaCtk->configPath());
+    m_journaledNote = m_codeNote;
+    saveSucceeded(m_codeNote);
+    return true;
+}
+
+// 返回true表示有单元格正在写出内容，全部完成后由onContentStored()继续保存
+bool NoteTab::storePendingContent()
+{
+    // 写出期间被删除的单元格不会再发出contentStored()
+    m_storingCells.removeAll(QPointer<ItemCell>());
+    if(!m_storingCells.isEmpty()) return true;
+    for(ItemCell *cell : itemCells())
+    {
+        if(!cell->hasPendingContent()) continue;
+        m_storingCells.append(cell);
+        QObject::connect(cell, &ItemCell::contentStored, this, &NoteTab::onContentStored, Qt::UniqueConnection);
+        cell->storePendingContent();
+    }
+    return !m_storingCells.isEmpty();
+}
+
+void NoteTab::onContentStored()
+{
+    m_storingCells.removeAll(qobject_cast<ItemCell*>(sender()));
+    m_storingCells.removeAll(QPointer<ItemCell>());
+    if(!m_storingCells.isEmpty()) return;
+    // 写出期间又有编辑的单元格会再次写出
+    save();
+}
 
+// 只处理本标签页最近一次提交的保存：更早的快照已被合并或之后还有更新的快照，
+// 其失败由更新的快照弥补，其成功等最新的快照完成后一起处理
+void NoteTab::onSaveFinished(const QString &configPath, bool success, quint64 ticket)
+{
+    if(m_savingTicket == 0 || ticket != m_savingTicket || !m_metaCtk || configPath != m_metaCtk->configPath()) return;
+    m_savingTicket = 0;
+
+    if(!success)
+    {
+        // 日志中保存开始后的记录是相对快照的差量，补写相对保存前内容的差量，重放时仍能得到最新内容
+        AutoSaveManager::getAutoSaveManager()->registerJournal(configPath);
+        m_journal.appendChanges(m_savingBase, m_journaledNote);
+        m_isSaved = false;
+        emit savedChanged(false);
+        QMessageBox::warning(this, "错误", QString("笔记写入失败，修改仍保留在编辑器中：%1").arg(configPath));
+        return;
+    }
+    saveSucceeded(m_savingNote);
+}
+
+// 写入成功：记录历史版本、同步标签；保存期间没有新的编辑时标记为已保存
+void NoteTab::saveSucceeded(const CodeNote &codeNote)
+{
+    // 记录历史版本（后台计算差量）
+    HistoryManager::getHistoryManager()->recordRevision(m_metaCtk->id(), codeNote);
     syncTagsToDatabase();
 
+    if(m_editSerial != m_savingSerial) return;
     m_isSaved = true;
     emit savedChanged(true);
     qInfo() << "saved successfully";
 }
 
+void NoteTab::discardChanges()
+{
+    m_journalTimer->stop();
+    m_compactTimer->stop();
+    if(m_metaCtk) AutoSaveManager::getAutoSaveManager()->discardJournal(m_metaCtk->configPath());
+}
+
+void NoteTab::showHistory()
+{
+    if(!m_metaCtk) return;
+    HistoryDialog *dialog = new HistoryDialog(m_metaCtk->id(), this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    // 恢复的内容作为未保存的修改载入
+    QObject::connect(dialog, &HistoryDialog::restoreRequested, this, [=](const CodeNote &codeNote){
+        m_codeNote = codeNote;
+        updateContent();
+        m_isSaved = false;
+        emit savedChanged(false);
+    });
+    dialog->show();
+}
+
+void NoteTab::onContentEdited()
+{
+    AutoSaveManager *autoSaveManager = AutoSaveManager::getAutoSaveManager();
+    if(!autoSaveManager->autoSave() || !m_metaCtk) return;
+
+    m_journalTimer->start(autoSaveManager->journalInterval()); // 重新计时
+    if(!m_compactTimer->isActive()) m_compactTimer->start(autoSaveManager->compactInterval());
+}
+
+// 只追加变化的项，代价与修改量成正比
+void NoteTab::flushJournal()
+{
+    m_journalTimer->stop();
+    if(m_isSaved || !m_metaCtk) return;
+    syncContent();
+    AutoSaveManager::getAutoSaveManager()->registerJournal(m_metaCtk->configPath());
+    if(m_journal.appendChanges(m_journaledNote, m_codeNote) < 0) return;
+    m_journaledNote = m_codeNote;
+
+    if(m_journal.size() > AutoSaveManager::getAutoSaveManager()->compactThreshold()) save();
+}
+
 void NoteTab::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
@@ -232,6 +410,7 @@ void NoteTab::initNoteTabUI()
     QObject::connect(m_tagsWidget, &TagsWidget::tagsChanged, [=](const QMap<QString, QStringList> &tags){
         m_codeNote.tags = tags;
         m_isSaved = false;
+        emit savedChanged(false);
         save();
     });
     QObject::connect(m_tagsWidget, &TagsWidget::tagRemovedFromGroup,
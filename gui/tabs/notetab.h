@@ -21,8 +21,11 @@
 * @history
 *****************************************************/
 
+#include <QPointer>
 #include <QWidget>
 #include "code_types.h"
+#include "projectmanager.h"
+#include "notejournal.h"
 
 class QScrollArea;
 class QVBoxLayout;
@@ -30,8 +33,9 @@ class TagsWidget;
 class PopoverWidget;
 class QToolButton;
 class NoteEditor;
-class MetaCtk;
 class QStackedLayout;
+class QTimer;
+class ItemCell;
 
 class NoteTab : public QWidget
 {
@@ -44,7 +48,11 @@ public:
     bool isSaved() const;
 
     virtual void load();
-    virtual void save();
+    virtual void save();    // 后台保存，写入成功（saveFinished）后才标记为已保存
+    bool saveNow();         // 立即保存并返回结果（关闭标签页时使用）
+    void discardChanges(); // 放弃未保存的编辑（删除编辑日志）
+    void flushJournal();   // 立即把防抖中的编辑追加到日志
+    void showHistory();    // 历史版本对话框
 
 signals:
     void savedChanged(bool isSaved);
@@ -54,6 +62,8 @@ protected:
     void resizeEvent(QResizeEvent *event) override;
 
     virtual void updateContent();
+    virtual void syncContent() {}   // 把编辑器中未同步的修改写入m_codeNote，保存、写日志前调用
+    virtual QList<ItemCell*> itemCells() const { return {}; } // syncContent()取内容的单元格
     QToolButton *createToolButton();
     void syncTagsToDatabase();
 
@@ -66,9 +76,23 @@ protected:
 
     TagsWidget *m_tagsWidget;
     CodeNote m_codeNote;
-    MetaCtk *m_metaCtk;
+    MetaCtkHandle m_metaCtk; // 固定缓存项，标签页打开期间不会被淘汰
     bool m_isSaved = false;
 
+    // ==== 后台保存 ====
+    quint64 m_savingTicket = 0;     // 最近一次提交的保存（SaveQueue编号），0表示没有等待中的保存
+    quint64 m_editSerial = 0;       // 每次编辑加一，判断保存期间是否又有修改
+    quint64 m_savingSerial = 0;     // 正在保存的快照对应的编辑序号
+    CodeNote m_savingNote;          // 正在保存的内容
+    CodeNote m_savingBase;          // 保存开始前已写入日志的内容，保存失败时据此补写日志
+    QList<QPointer<ItemCell>> m_storingCells; // 保存前正在后台写出内容（大内容入库）的单元格
+
+    // ==== 自动保存 ====
+    NoteJournal m_journal;
+    CodeNote m_journaledNote;       // 已写入日志的内容
+    QTimer *m_journalTimer;         // 编辑防抖，到时追加日志
+    QTimer *m_compactTimer;         // 到时保存（压缩日志）
+
     PopoverWidget *m_popover;
 
     // 布局堆栈
@@ -84,6 +108,11 @@ private slots:
 
 private:
     void initNoteTabUI();
+    void onContentEdited();
+    void onSaveFinished(const QString& configPath, bool success, quint64 ticket);
+    bool storePendingContent();
+    void onContentStored();
+    void saveSucceeded(const CodeNote& codeNote);
     int calculateSmartMargin(int availableWidth);
     double smoothStep(double x);
 
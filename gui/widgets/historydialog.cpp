@@ -0,0 +1,108 @@
+#include "historydialog.h"
+#include "historymanager.h"
+
+#include <QHBoxLayout>
+#include <QListWidget>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+HistoryDialog::HistoryDialog(const QString &uuid, QWidget *parent)
+    : Dialog(parent),
+      m_uuid(uuid)
+{
+    initUI();
+    loadRevisions();
+}
+
+void HistoryDialog::initUI()
+{
+    QVBoxLayout *mainVLayout = new QVBoxLayout(m_centralWidget);
+    mainVLayout->setSpacing(10);
+    mainVLayout->setContentsMargins(20, 50, 20, 20);
+
+    QHBoxLayout *contentHLayout = new QHBoxLayout;
+    contentHLayout->setSpacing(10);
+    contentHLayout->setContentsMargins(0, 0, 0, 0);
+
+    m_revisionList = new QListWidget;
+    m_revisionList->setFixedWidth(240);
+
+    m_previewEdit = new QPlainTextEdit;
+    m_previewEdit->setReadOnly(true);
+    m_previewEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    contentHLayout->addWidget(m_revisionList);
+    contentHLayout->addWidget(m_previewEdit, 1);
+
+    QHBoxLayout *buttonHLayout = new QHBoxLayout;
+    buttonHLayout->setContentsMargins(0, 0, 0, 0);
+    m_restoreButton = new QPushButton("恢复此版本");
+    m_restoreButton->setEnabled(false);
+    buttonHLayout->addStretch();
+    buttonHLayout->addWidget(m_restoreButton);
+
+    mainVLayout->addLayout(contentHLayout, 1);
+    mainVLayout->addLayout(buttonHLayout);
+
+    m_centralWidget->setFixedSize(800, 560);
+    setFixedSize(m_centralWidget->size());
+
+    QObject::connect(m_revisionList, &QListWidget::currentRowChanged, this, [=](int row){
+        if(row < 0) return;
+        showRevision(m_revisionList->item(row)->data(Qt::UserRole).toInt());
+    });
+    QObject::connect(m_restoreButton, &QPushButton::clicked, this, [=](){
+        emit restoreRequested(m_currentNote);
+        close();
+    });
+}
+
+// 只读取索引，不解码内容
+void HistoryDialog::loadRevisions()
+{
+    QVector<RevisionInfo> revisions = HistoryManager::getHistoryManager()->revisions(m_uuid);
+    // 最新的版本在最上面
+    for(int i = revisions.size() - 1; i >= 0; i--)
+    {
+        const RevisionInfo &info = revisions[i];
+        QString text = QString("#%1  %2  %3KB")
+                .arg(info.index + 1)
+                .arg(info.time.toString("yyyy/MM/dd hh:mm:ss"))
+                .arg(info.size / 1024.0, 0, 'f', 1);
+        QListWidgetItem *item = new QListWidgetItem(text);
+        item->setData(Qt::UserRole, info.index);
+        m_revisionList->addItem(item);
+    }
+    if(revisions.isEmpty()) m_previewEdit->setPlainText("暂无历史版本");
+}
+
+void HistoryDialog::showRevision(int index)
+{
+    bool ok = false;
+    m_currentNote = HistoryManager::getHistoryManager()->restoreRevision(m_uuid, index, &ok);
+    m_restoreButton->setEnabled(ok);
+    m_previewEdit->setPlainText(ok ? previewText(m_currentNote) : "该版本已损坏，无法恢复");
+}
+
+QString HistoryDialog::previewText(const CodeNote &codeNote)
+{
+    QString text;
+    for(auto it = codeNote.tags.begin(); it != codeNote.tags.end(); it++)
+    {
+        text += QString("[%1] %2\n").arg(it.key(), it.value().join(", "));
+    }
+    for(const NoteItem &item : codeNote.note)
+    {
+        switch(item.type)
+        {
+        case NType::Text: text += "\n==== 纯文本 ====\n"; break;
+        case NType::Image: text += "\n==== 图片 ====\n"; break;
+        case NType::Markdown: text += "\n==== markdown ====\n"; break;
+        case NType::Code: text += QString("\n==== 代码(%1) ====\n").arg(item.language); break;
+        }
+        if(item.external) text += QString("（外部内容: %1）\n").arg(item.content);
+        else text += item.content + "\n";
+    }
+    return text;
+}
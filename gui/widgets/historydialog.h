@@ -0,0 +1,50 @@
+#ifndef HISTORYDIALOG_H
+#define HISTORYDIALOG_H
+/*****************************************************
+*
+* @file     historydialog.h
+* @brief    笔记历史版本对话框
+*
+* @description
+*           ==== 布局 ====
+*           左侧：版本列表（序号、时间、大小）
+*           右侧：所选版本的内容预览
+*           底部：恢复按钮
+*           ==== 使用说明 ====
+*           选择版本后点击“恢复此版本”，发出restoreRequested()，由NoteTab载入（不会自动保存）
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <dialog.h>
+#include "code_types.h"
+
+class QListWidget;
+class QPlainTextEdit;
+class QPushButton;
+class HistoryDialog : public Dialog
+{
+    Q_OBJECT
+public:
+    explicit HistoryDialog(const QString& uuid, QWidget *parent = nullptr);
+
+signals:
+    void restoreRequested(const CodeNote& codeNote);
+
+private:
+    void initUI();
+    void loadRevisions();
+    void showRevision(int index);
+    static QString previewText(const CodeNote& codeNote);
+
+    QString m_uuid;
+    CodeNote m_currentNote;
+
+    QListWidget *m_revisionList;
+    QPlainTextEdit *m_previewEdit;
+    QPushButton *m_restoreButton;
+};
+
+#endif // HISTORYDIALOG_H
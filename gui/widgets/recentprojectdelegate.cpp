@@ -0,0 +1,163 @@
+#include "recentprojectdelegate.h"
+#include "recentprojectmodel.h"
+#include "stylemanager.h"
+
+#include <QApplication>
+#include <QFontMetrics>
+#include <QPainter>
+
+namespace {
+const int MARGIN_H = 10;
+const int MARGIN_V = 8;
+const int SPACING = 12;
+const int IMAGE_BOX = 50;   // 与原ImageLabel大小一致（40 * 1.25）
+const int BOTTOM_SPACING = 5;
+}
+
+RecentProjectDelegate::RecentProjectDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+    m_layouts.setMaxCost(256);
+}
+
+void RecentProjectDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+
+    // "暂无项目"提示行
+    if(index.data(RecentProjectModel::PathRole).toString().isEmpty())
+    {
+        style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+        return;
+    }
+
+    // 背景（悬停、选中）
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, widget);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    bool light = StyleManager::getStyleManager()->currentTheme() == Theme::LightTheme;
+
+    // 左侧缩略图
+    QRect imageRect(opt.rect.left() + MARGIN_H, opt.rect.top() + MARGIN_V, IMAGE_BOX, IMAGE_BOX);
+    painter->setPen(QColor(light ? "#e0e0e0" : "#404040"));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRoundedRect(QRectF(imageRect).adjusted(0.5, 0.5, -0.5, -0.5), 4, 4);
+
+    QSize thumbnailSize = RecentProjectModel::thumbnailSize();
+    QPixmap pixmap = qvariant_cast<QPixmap>(index.data(Qt::DecorationRole));
+    if(pixmap.isNull())
+    {
+        // 缩略图生成前显示默认图标
+        QRect iconRect(QPoint(0, 0), thumbnailSize);
+        iconRect.moveCenter(imageRect.center());
+        placeholderIcon().paint(painter, iconRect);
+    }
+    else
+    {
+        QSize pixmapSize = pixmap.size() / pixmap.devicePixelRatio();
+        QRect pixmapRect(QPoint(0, 0), pixmapSize);
+        pixmapRect.moveCenter(imageRect.center());
+        painter->drawPixmap(pixmapRect, pixmap);
+    }
+
+    // 右侧文本
+    QRect infoRect(imageRect.right() + 1 + SPACING, imageRect.top(),
+                   opt.rect.right() - MARGIN_H - imageRect.right() - SPACING, IMAGE_BOX);
+    const RowLayout *layout = rowLayout(index, opt.font, infoRect.width());
+    if(layout)
+    {
+        QColor textColor = opt.palette.color(opt.state & QStyle::State_Selected ? QPalette::HighlightedText
+                                                                                 : QPalette::Text);
+        // drawStaticText使用画笔当前字体，与prepare时不同会重新排版
+        painter->setPen(textColor);
+        painter->setFont(layout->nameFont);
+        painter->drawStaticText(infoRect.topLeft(), layout->nameText);
+
+        painter->setPen(QColor(Qt::gray));
+        painter->setFont(layout->smallFont);
+        int bottom = infoRect.bottom() + 1;
+        int y = bottom - qRound(layout->modifiedText.size().height());
+        int idWidth = qRound(layout->idText.size().width());
+        int parentWidth = qRound(layout->parentText.size().width());
+        painter->drawStaticText(infoRect.left(), y, layout->modifiedText);
+        painter->drawStaticText(infoRect.right() + 1 - idWidth, y, layout->idText);
+        painter->setFont(layout->parentFont);
+        painter->drawStaticText(infoRect.right() + 1 - idWidth - BOTTOM_SPACING - parentWidth, y, layout->parentText);
+    }
+    painter->restore();
+}
+
+QSize RecentProjectDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(option)
+    Q_UNUSED(index)
+    // 所有行等高，配合setUniformItemSizes使用
+    return QSize(200, IMAGE_BOX + 2 * MARGIN_V);
+}
+
+// 排版结果按节点ID缓存，宽度、字体或数据变化时重新排版
+const RecentProjectDelegate::RowLayout *RecentProjectDelegate::rowLayout(const QModelIndex &index,
+                                                                      const QFont &baseFont, int width) const
+{
+    int nodeId = index.data(RecentProjectModel::NodeIdRole).toInt();
+    QString name = index.data(RecentProjectModel::NameRole).toString();
+    QString parentName = index.data(RecentProjectModel::ParentNameRole).toString();
+    QString modified = index.data(RecentProjectModel::ModifiedRole).toDateTime().toString("yyyy-MM-dd");
+
+    RowLayout *layout = m_layouts.object(nodeId);
+    if(layout && layout->width == width && layout->font == baseFont && layout->name == name
+            && layout->parentName == parentName && layout->modified == modified)
+    {
+        return layout;
+    }
+
+    layout = new RowLayout;
+    layout->width = width;
+    layout->font = baseFont;
+    layout->name = name;
+    layout->parentName = parentName;
+    layout->modified = modified;
+
+    QFont &nameFont = layout->nameFont;
+    nameFont = baseFont;
+    nameFont.setBold(true);
+    nameFont.setPixelSize(14);
+    QFont &smallFont = layout->smallFont;
+    smallFont = baseFont;
+    smallFont.setPixelSize(12);
+    QFont &parentFont = layout->parentFont;
+    parentFont = smallFont;
+    parentFont.setItalic(true);
+
+    layout->nameText = makeText(QFontMetrics(nameFont).elidedText(name, Qt::ElideRight, width), nameFont);
+    layout->modifiedText = makeText(modified, smallFont);
+    layout->idText = makeText(QString("ID: %1").arg(nodeId), smallFont);
+
+    // 父节点名称占用日期和ID之间的剩余宽度
+    int available = width - qRound(layout->modifiedText.size().width())
+            - qRound(layout->idText.size().width()) - 2 * BOTTOM_SPACING;
+    QString parentText = QFontMetrics(parentFont).elidedText(parentName, Qt::ElideLeft, qMax(0, available));
+    layout->parentText = makeText(parentText, parentFont);
+
+    m_layouts.insert(nodeId, layout);
+    return layout;
+}
+
+QStaticText RecentProjectDelegate::makeText(const QString &text, const QFont &font)
+{
+    QStaticText staticText(text);
+    staticText.setTextFormat(Qt::PlainText);
+    staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+    staticText.prepare(QTransform(), font);
+    return staticText;
+}
+
+QIcon RecentProjectDelegate::placeholderIcon() const
+{
+    static QIcon lightIcon(":/res/icon/codenote.svg");
+    static QIcon darkIcon(":/res/icon/codenote-light.svg");
+    return StyleManager::getStyleManager()->currentTheme() == Theme::LightTheme ? lightIcon : darkIcon;
+}
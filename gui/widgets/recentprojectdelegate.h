@@ -0,0 +1,62 @@
+#ifndef RECENTPROJECTDELEGATE_H
+#define RECENTPROJECTDELEGATE_H
+/*****************************************************
+*
+* @file     recentprojectdelegate.h
+* @brief    首页最近项目列表的绘制代理
+*
+* @description
+*           ==== 布局 ====
+*           左侧缩略图（带边框），右侧上方项目名，下方修改日期、父节点名称、节点ID
+*           ==== 核心功能 ====
+*           - 直接绘制每一行，列表不创建任何子控件，内存只与可见行数有关
+*           - 文本使用QStaticText，按节点ID和可用宽度缓存，滚动时不重复排版
+*           ==== 注意 ====
+*           颜色与字号对应样式表中原#projectName/#projectModified/#projectParent/#projectId的设置
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QCache>
+#include <QIcon>
+#include <QStaticText>
+#include <QStyledItemDelegate>
+
+class RecentProjectDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit RecentProjectDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+    void clearCache() { m_layouts.clear(); }
+
+private:
+    // 一行已排版的文本
+    struct RowLayout {
+        int width = 0;
+        QFont font;             // 列表字体
+        QFont nameFont;
+        QFont smallFont;
+        QFont parentFont;
+        QString name;           // 用于判断数据是否变化
+        QString parentName;
+        QString modified;
+        QStaticText nameText;
+        QStaticText modifiedText;
+        QStaticText parentText;
+        QStaticText idText;
+    };
+
+    const RowLayout *rowLayout(const QModelIndex& index, const QFont& baseFont, int width) const;
+    static QStaticText makeText(const QString& text, const QFont& font);
+    QIcon placeholderIcon() const;
+
+    mutable QCache<int, RowLayout> m_layouts; // 节点ID -> 排版结果
+};
+
+#endif // RECENTPROJECTDELEGATE_H
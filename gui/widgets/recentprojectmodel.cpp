@@ -0,0 +1,92 @@
+#include "recentprojectmodel.h"
+#include "thumbnailcache.h"
+
+#include <QPixmap>
+
+RecentProjectModel::RecentProjectModel(QObject *parent) : QAbstractListModel(parent)
+{
+    QObject::connect(ThumbnailCache::getThumbnailCache(), &ThumbnailCache::thumbnailReady,
+                     this, &RecentProjectModel::onThumbnailReady);
+}
+
+void RecentProjectModel::setProjects(const QVector<RecentProject> &projects)
+{
+    beginResetModel();
+    m_projects = projects;
+    m_rowsByImage.clear();
+    for(int row = 0; row < m_projects.size(); row++)
+    {
+        if(!m_projects[row].imagePath.isEmpty()) m_rowsByImage[m_projects[row].imagePath].append(row);
+    }
+    endResetModel();
+}
+
+const RecentProject *RecentProjectModel::project(int row) const
+{
+    if(row < 0 || row >= m_projects.size()) return nullptr;
+    return &m_projects[row];
+}
+
+bool RecentProjectModel::isEmptyHint(const QModelIndex &index) const
+{
+    return index.isValid() && m_projects.isEmpty();
+}
+
+int RecentProjectModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid()) return 0;
+    // 没有项目时显示一行提示
+    return m_projects.isEmpty() ? 1 : m_projects.size();
+}
+
+QVariant RecentProjectModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid()) return QVariant();
+    if(m_projects.isEmpty())
+    {
+        if(role == Qt::DisplayRole) return QStringLiteral("暂无项目");
+        if(role == Qt::TextAlignmentRole) return int(Qt::AlignCenter);
+        return QVariant();
+    }
+
+    const RecentProject *item = project(index.row());
+    if(!item) return QVariant();
+    switch(role)
+    {
+    case Qt::DisplayRole:
+    case NameRole:
+        return item->name;
+    case Qt::DecorationRole:
+        // 未生成时返回空图，生成后onThumbnailReady通知重绘
+        return ThumbnailCache::getThumbnailCache()->thumbnail(item->imagePath, thumbnailSize());
+    case PathRole:
+        return item->path;
+    case ImagePathRole:
+        return item->imagePath;
+    case NodeIdRole:
+        return item->nodeId;
+    case ParentNameRole:
+        return item->parentName;
+    case ModifiedRole:
+        return item->modified;
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags RecentProjectModel::flags(const QModelIndex &index) const
+{
+    if(!index.isValid() || m_projects.isEmpty()) return Qt::NoItemFlags; // 提示行不可点击
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+void RecentProjectModel::onThumbnailReady(const QString &imagePath, const QSize &size)
+{
+    if(size != thumbnailSize()) return;
+    const QVector<int> rows = m_rowsByImage.value(imagePath);
+    for(int row : rows)
+    {
+        QModelIndex changed = index(row);
+        emit dataChanged(changed, changed, {Qt::DecorationRole});
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef RECENTPROJECTMODEL_H
+#define RECENTPROJECTMODEL_H
+/*****************************************************
+*
+* @file     recentprojectmodel.h
+* @brief    首页最近项目列表模型
+*
+* @description
+*           ==== 核心功能 ====
+*           - 保存最近项目的显示数据，由RecentProjectDelegate直接绘制，不为每行创建控件
+*           - 缩略图由ThumbnailCache在后台生成，生成后只通知对应行重绘
+*           ==== 数据角色 ====
+*           PathRole(Qt::UserRole)  项目完整路径（为空表示"暂无项目"提示行）
+*           Qt::DecorationRole      缩略图（未生成时为空）
+*           ==== 注意 ====
+*           没有项目时模型只有一行提示，不可选中
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QHash>
+#include <QSize>
+#include <QVector>
+
+// 最近项目
+struct RecentProject {
+    int nodeId = 0;
+    QString name;
+    QString imagePath;
+    QString path;
+    QString parentName;
+    QDateTime modified;
+};
+
+class RecentProjectModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        PathRole = Qt::UserRole,
+        NameRole,
+        ImagePathRole,
+        NodeIdRole,
+        ParentNameRole,
+        ModifiedRole
+    };
+
+    explicit RecentProjectModel(QObject *parent = nullptr);
+
+    void setProjects(const QVector<RecentProject>& projects);
+    const RecentProject *project(int row) const;
+    bool isEmptyHint(const QModelIndex& index) const;
+
+    static QSize thumbnailSize() { return QSize(40, 40); }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+private slots:
+    void onThumbnailReady(const QString& imagePath, const QSize& size);
+
+private:
+    QVector<RecentProject> m_projects;
+    QHash<QString, QVector<int>> m_rowsByImage; // 图片路径 -> 使用该图片的行
+};
+
+#endif // RECENTPROJECTMODEL_H
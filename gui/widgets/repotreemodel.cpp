@@ -0,0 +1,936 @@
+#include "repotreemodel.h"
+
+#include "projectmanager.h"
+#include "databasemanager.h"
+#include "thumbnailcache.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <algorithm>
+
+RepoTreeModel::RepoTreeModel(QObject *parent) : QAbstractItemModel(parent)
+{
+    m_projectManager = ProjectManager::getProjectManager();
+    m_nodes.resize(1);
+    m_nodes[0].used = true;
+
+    m_reconcileWatcher = new QFutureWatcher<QVector<DiskListing>>(this);
+    QObject::connect(m_reconcileWatcher, &QFutureWatcher<QVector<DiskListing>>::finished, this, [=](){
+        // 扫描期间模型已被重置时丢弃结果
+        if(m_reconcileGeneration == m_generation) applyReconcile(m_reconcileWatcher->result());
+    });
+
+    m_iconWatcher = new QFutureWatcher<QVector<IconRequest>>(this);
+    QObject::connect(m_iconWatcher, &QFutureWatcher<QVector<IconRequest>>::finished, this, [=](){
+        if(m_iconGeneration == m_generation) applyIconPaths(m_iconWatcher->result());
+        else m_resolvingIcons.clear();
+        // 读取期间又有新的节点等待
+        if(!m_unresolvedIcons.isEmpty()) resolveIconPaths();
+    });
+
+    QObject::connect(ThumbnailCache::getThumbnailCache(), &ThumbnailCache::thumbnailReady,
+                     this, &RepoTreeModel::onThumbnailReady);
+}
+
+void RepoTreeModel::setRootPath(const QString &rootPath, int rootNodeId)
+{
+    beginResetModel();
+    m_generation++;
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_names.clear();
+    m_nameIds.clear();
+    m_iconPaths.clear();
+    m_waitingIcons.clear();
+    m_unresolvedIcons.clear();
+    m_resolvingIcons.clear();
+
+    m_rootPath = QDir(rootPath).absolutePath();
+    m_nodes.resize(1);
+    m_nodes[0].used = true;
+    m_nodes[0].nodeId = rootNodeId;
+    endResetModel();
+}
+
+QString RepoTreeModel::rootPath() const
+{
+    return m_rootPath;
+}
+
+void RepoTreeModel::setIcons(const QIcon &folderIcon, const QIcon &fileIcon)
+{
+    m_folderIcon = folderIcon;
+    m_fileIcon = fileIcon;
+    // 只通知已插入的项重绘图标，项目自定义图标缓存不受主题影响
+    emitDecorationChanged(0);
+}
+
+QModelIndex RepoTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if(column != 0 || row < 0) return QModelIndex();
+    int node = nodeFor(parent);
+    if(node < 0 || row >= m_nodes[node].children.size()) return QModelIndex();
+    return createIndex(row, 0, quintptr(m_nodes[node].children[row]));
+}
+
+QModelIndex RepoTreeModel::parent(const QModelIndex &child) const
+{
+    int node = nodeFor(child);
+    if(node <= 0) return QModelIndex();
+    return indexFor(m_nodes[node].parent);
+}
+
+int RepoTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.column() > 0) return 0;
+    int node = nodeFor(parent);
+    return node < 0 ? 0 : m_nodes[node].children.size();
+}
+
+int RepoTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+QVariant RepoTreeModel::data(const QModelIndex &index, int role) const
+{
+    int node = nodeFor(index);
+    if(node <= 0) return QVariant();
+    const TreeNode &treeNode = m_nodes[node];
+
+    switch(role)
+    {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+    case NameRole:
+        return nameOf(node);
+    case Qt::DecorationRole:
+        return treeNode.kind == Project ? projectIcon(node) : m_folderIcon;
+    case PathRole:
+        return pathOf(node);
+    case TypeRole:
+        return treeNode.kind == Project ? QStringLiteral("PROJECT_FOLDER") : QStringLiteral("FOLDER");
+    case NodeIdRole:
+        return treeNode.nodeId;
+    default:
+        return QVariant();
+    }
+}
+
+bool RepoTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    int node = nodeFor(index);
+    if(node <= 0 || role != Qt::EditRole) return false;
+    return renameNode(node, value.toString());
+}
+
+Qt::ItemFlags RepoTreeModel::flags(const QModelIndex &index) const
+{
+    if(!index.isValid()) return Qt::NoItemFlags;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+}
+
+// 未读取的目录先认为有子项，展开时再读取
+bool RepoTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    int node = nodeFor(parent);
+    if(node < 0) return false;
+    const TreeNode &treeNode = m_nodes[node];
+    if(treeNode.kind == Project) return false;
+    if(!treeNode.listed) return true;
+    return !treeNode.children.isEmpty() || !treeNode.pending.isEmpty();
+}
+
+bool RepoTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    int node = nodeFor(parent);
+    if(node < 0) return false;
+    const TreeNode &treeNode = m_nodes[node];
+    if(treeNode.kind == Project) return false;
+    return !treeNode.listed || !treeNode.pending.isEmpty();
+}
+
+void RepoTreeModel::fetchMore(const QModelIndex &parent)
+{
+    int node = nodeFor(parent);
+    if(node < 0 || m_nodes[node].kind == Project) return;
+    if(!m_nodes[node].listed) listChildren(node);
+
+    TreeNode &treeNode = m_nodes[node];
+    int count = qMin(m_fetchBatchSize, treeNode.pending.size());
+    if(count <= 0) return;
+
+    int first = treeNode.children.size();
+    beginInsertRows(parent, first, first + count - 1);
+    for(int i = 0; i < count; i++)
+    {
+        int child = treeNode.pending[i];
+        m_nodes[child].row = first + i;
+        treeNode.children.append(child);
+    }
+    treeNode.pending.remove(0, count);
+    endInsertRows();
+}
+
+// 插入单个节点（新建分类/项目后调用），按名称排序插入
+QModelIndex RepoTreeModel::insertNode(const QModelIndex &parent, const Node &node)
+{
+    int parentNode = nodeFor(parent);
+    if(parentNode < 0 || m_nodes[parentNode].kind == Project) return QModelIndex();
+    // 尚未读取的目录在展开时会读到新节点
+    if(!m_nodes[parentNode].listed) return QModelIndex();
+    // 新建的目录为空，无需再读取
+    int child = insertChild(parentNode, node, true);
+    // 新项排在未插入的批次中时，只插入到新项所在的批次
+    QModelIndex parentIndex = indexFor(parentNode);
+    while(child > 0 && !isInserted(child) && canFetchMore(parentIndex)) fetchMore(parentIndex);
+    return isInserted(child) ? indexFor(child) : QModelIndex();
+}
+
+// 父节点还有未插入的子项时，排在已插入项之后的新节点放入pending，随批次插入
+int RepoTreeModel::insertChild(int parentNode, const Node &node, bool listed)
+{
+    int existing = findChild(parentNode, node.name);
+    if(existing > 0) return existing;
+    existing = findPending(parentNode, node.name);
+    if(existing > 0) return existing;
+
+    int child = allocNode();
+    TreeNode &treeNode = m_nodes[child];
+    treeNode.nodeId = node.id;
+    treeNode.parent = parentNode;
+    treeNode.nameId = internName(node.name);
+    treeNode.kind = node.type == NodeType::Note ? Project : Folder;
+    treeNode.listed = listed && treeNode.kind == Folder;
+
+    int row = insertPosition(parentNode, node.name);
+    QVector<int> &pending = m_nodes[parentNode].pending;
+    if(!pending.isEmpty() && row == m_nodes[parentNode].children.size())
+    {
+        auto it = std::lower_bound(pending.begin(), pending.end(), node.name, [this](int other, const QString &value){
+            return nameOf(other).compare(value) < 0;
+        });
+        pending.insert(it, child);
+        return child;
+    }
+
+    beginInsertRows(indexFor(parentNode), row, row);
+    m_nodes[parentNode].children.insert(row, child);
+    renumber(parentNode, row);
+    endInsertRows();
+    return child;
+}
+
+void RepoTreeModel::removeNode(const QModelIndex &index)
+{
+    int node = nodeFor(index);
+    if(node <= 0) return;
+    int parentNode = m_nodes[node].parent;
+    int row = m_nodes[node].row;
+
+    beginRemoveRows(index.parent(), row, row);
+    m_nodes[parentNode].children.remove(row);
+    renumber(parentNode, row);
+    freeNode(node);
+    endRemoveRows();
+}
+
+void RepoTreeModel::refreshIcon(const QModelIndex &index)
+{
+    int node = nodeFor(index);
+    if(node <= 0) return;
+    m_iconPaths.remove(node);
+    // 正在读取的结果可能是修改前的，丢弃后重新读取
+    m_resolvingIcons.remove(node);
+    emit dataChanged(index, index, {Qt::DecorationRole});
+}
+
+QModelIndex RepoTreeModel::indexForPath(const QString &path)
+{
+    QString cleanPath = QDir::cleanPath(QDir(path).absolutePath());
+    if(cleanPath == m_rootPath) return QModelIndex();
+    if(!cleanPath.startsWith(m_rootPath + "/")) return QModelIndex();
+
+    const QStringList parts = cleanPath.mid(m_rootPath.size() + 1).split('/', Qt::SkipEmptyParts);
+    int node = 0;
+    for(const QString &part : parts)
+    {
+        if(m_nodes[node].kind == Project) return QModelIndex();
+        fetchAll(node);
+        node = findChild(node, part);
+        if(node <= 0) return QModelIndex();
+    }
+    return indexFor(node);
+}
+
+// 只在已插入的项中查找，不读取目录
+QModelIndex RepoTreeModel::loadedIndexForPath(const QString &path) const
+{
+    QString cleanPath = QDir::cleanPath(QDir(path).absolutePath());
+    if(!cleanPath.startsWith(m_rootPath + "/")) return QModelIndex();
+
+    const QStringList parts = cleanPath.mid(m_rootPath.size() + 1).split('/', Qt::SkipEmptyParts);
+    int node = 0;
+    for(const QString &part : parts)
+    {
+        node = findChild(node, part);
+        if(node <= 0) return QModelIndex();
+    }
+    return indexFor(node);
+}
+
+bool RepoTreeModel::isFolder(const QModelIndex &index) const
+{
+    int node = nodeFor(index);
+    return node >= 0 && m_nodes[node].kind == Folder;
+}
+
+int RepoTreeModel::nodeFor(const QModelIndex &index) const
+{
+    if(!index.isValid()) return 0;
+    if(index.model() != this) return -1;
+    int node = int(index.internalId());
+    if(node <= 0 || node >= m_nodes.size() || !m_nodes[node].used) return -1;
+    return node;
+}
+
+QModelIndex RepoTreeModel::indexFor(int node) const
+{
+    if(node <= 0) return QModelIndex();
+    return createIndex(m_nodes[node].row, 0, quintptr(node));
+}
+
+int RepoTreeModel::allocNode()
+{
+    int node;
+    if(!m_freeNodes.isEmpty())
+    {
+        node = m_freeNodes.takeLast();
+        m_nodes[node] = TreeNode();
+    }
+    else
+    {
+        node = m_nodes.size();
+        m_nodes.append(TreeNode());
+    }
+    m_nodes[node].used = true;
+    return node;
+}
+
+// 释放节点及其全部子项
+void RepoTreeModel::freeNode(int node)
+{
+    const QVector<int> children = m_nodes[node].children + m_nodes[node].pending;
+    for(int child : children) freeNode(child);
+    m_iconPaths.remove(node);
+    m_unresolvedIcons.remove(node);
+    m_resolvingIcons.remove(node);
+    m_nodes[node] = TreeNode();
+    m_freeNodes.append(node);
+}
+
+int RepoTreeModel::internName(const QString &name)
+{
+    auto it = m_nameIds.constFind(name);
+    if(it != m_nameIds.constEnd()) return it.value();
+    int id = m_names.size();
+    m_names.append(name);
+    m_nameIds.insert(name, id);
+    return id;
+}
+
+QString RepoTreeModel::nameOf(int node) const
+{
+    int nameId = m_nodes[node].nameId;
+    return nameId < 0 ? QString() : m_names[nameId];
+}
+
+// 路径不存储，沿父节点拼接
+QString RepoTreeModel::pathOf(int node) const
+{
+    QStringList parts;
+    for(int current = node; current > 0; current = m_nodes[current].parent)
+    {
+        parts.prepend(nameOf(current));
+    }
+    if(parts.isEmpty()) return m_rootPath;
+    return m_rootPath + "/" + parts.join('/');
+}
+
+// 读取目录的子项列表，补全节点表中缺少的节点（每个目录只查询一次数据库）
+void RepoTreeModel::listChildren(int node)
+{
+    m_nodes[node].listed = true;
+
+    QString path = pathOf(node);
+    if(!m_projectManager->isRepositoryItem(path))
+    {
+        qWarning() << "It is not the repository directory: " << path;
+        return;
+    }
+    QDir dir(path);
+    if(!dir.exists()) return;
+
+    // 只获取目录（忽略文件）
+    const QStringList entries = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    if(entries.isEmpty()) return;
+
+    int parentNodeId = m_nodes[node].nodeId;
+    const QHash<QString, int> dbIds = dbNodeIds(parentNodeId);
+
+    QVector<int> pending;
+    pending.reserve(entries.size());
+    for(const QString &entryName : entries)
+    {
+        // 检查是否为项目文件夹（包含meta.ctk文件）
+        QString metaPath = path + "/" + entryName + "/meta.ctk";
+        bool isProject = QFile::exists(metaPath);
+        int nodeId = ensureDbNode(dbIds, parentNodeId, entryName, isProject, metaPath);
+
+        int child = allocNode();
+        TreeNode &treeNode = m_nodes[child];
+        treeNode.nodeId = nodeId;
+        treeNode.parent = node;
+        treeNode.nameId = internName(entryName);
+        treeNode.kind = isProject ? Project : Folder;
+        pending.append(child);
+    }
+    m_nodes[node].pending = pending;
+}
+
+// 父节点下已有的节点ID，键为类型前缀+名称
+QHash<QString, int> RepoTreeModel::dbNodeIds(int parentNodeId) const
+{
+    QHash<QString, int> ids;
+    const QVector<Node> dbNodes = m_projectManager->getDbManager()->nodesByParent(parentNodeId);
+    for(const Node &dbNode : dbNodes)
+    {
+        ids.insert(dbKey(dbNode.name, dbNode.type == NodeType::Note), dbNode.id);
+    }
+    return ids;
+}
+
+QString RepoTreeModel::dbKey(const QString &name, bool isProject)
+{
+    return (isProject ? QStringLiteral("N/") : QStringLiteral("C/")) + name;
+}
+
+// 返回节点表中同名同类型的节点ID，没有则创建
+int RepoTreeModel::ensureDbNode(const QHash<QString, int> &dbIds, int parentNodeId, const QString &name,
+                                bool isProject, const QString &metaPath)
+{
+    int nodeId = dbIds.value(dbKey(name, isProject));
+    if(nodeId != 0) return nodeId;
+
+    // 创建新节点
+    DatabaseManager *dbManager = m_projectManager->getDbManager();
+    Node newNode;
+    newNode.name = name;
+    newNode.type = isProject ? NodeType::Note : NodeType::Catalog;
+    newNode.parentId = parentNodeId;
+    nodeId = dbManager->addNode(newNode);
+
+    // 创建对应的Note
+    MetaCtk *metaCtk = isProject ? m_projectManager->getMetaCtk(metaPath) : nullptr;
+    if(metaCtk && metaCtk->load())
+    {
+        Note note;
+        note.nodeId = nodeId;
+        note.projectName = name;
+        note.imagePath = metaCtk->demoImagePath();
+        note.author = metaCtk->author();
+        note.uuid = metaCtk->id();
+        dbManager->addNote(note);
+    }
+    return nodeId;
+}
+
+void RepoTreeModel::fetchAll(int node)
+{
+    QModelIndex parent = indexFor(node);
+    while(canFetchMore(parent)) fetchMore(parent);
+}
+
+int RepoTreeModel::findChild(int node, const QString &name) const
+{
+    auto it = m_nameIds.constFind(name);
+    if(it == m_nameIds.constEnd()) return -1;
+    for(int child : qAsConst(m_nodes[node].children))
+    {
+        if(m_nodes[child].nameId == it.value()) return child;
+    }
+    return -1;
+}
+
+int RepoTreeModel::findPending(int node, const QString &name) const
+{
+    auto it = m_nameIds.constFind(name);
+    if(it == m_nameIds.constEnd()) return -1;
+    for(int child : qAsConst(m_nodes[node].pending))
+    {
+        if(m_nodes[child].nameId == it.value()) return child;
+    }
+    return -1;
+}
+
+// 与QDir::Name排序一致
+int RepoTreeModel::insertPosition(int parent, const QString &name) const
+{
+    const QVector<int> &children = m_nodes[parent].children;
+    auto it = std::lower_bound(children.begin(), children.end(), name, [this](int child, const QString &value){
+        return nameOf(child).compare(value) < 0;
+    });
+    return int(it - children.begin());
+}
+
+void RepoTreeModel::emitDecorationChanged(int node)
+{
+    const QVector<int> &children = m_nodes[node].children;
+    if(children.isEmpty()) return;
+    emit dataChanged(createIndex(0, 0, quintptr(children.first())),
+                     createIndex(children.size() - 1, 0, quintptr(children.last())),
+                     {Qt::DecorationRole});
+    for(int child : children)
+    {
+        if(m_nodes[child].kind == Folder) emitDecorationChanged(child);
+    }
+}
+
+void RepoTreeModel::renumber(int parent, int fromRow)
+{
+    QVector<int> &children = m_nodes[parent].children;
+    for(int row = fromRow; row < children.size(); row++)
+    {
+        m_nodes[children[row]].row = row;
+    }
+}
+
+bool RepoTreeModel::renameNode(int node, const QString &name)
+{
+    QString newName = name;
+    QString oldName = nameOf(node);
+    QString path = pathOf(node);
+    QString parentPath = QFileInfo(path).path();
+    if(oldName.isEmpty() || newName == oldName) return false;
+
+    newName = m_projectManager->sanitizeFileName(newName);
+    if(newName.isEmpty()) return false;
+    newName = m_projectManager->autoRename(newName, parentPath);
+    if(newName == oldName) return false;
+
+    // 文件重命名
+    if(!m_projectManager->renameItem(newName, path, m_nodes[node].nodeId)) return false;
+
+    // 子项路径由父节点拼接，只需更新名称
+    m_nodes[node].nameId = internName(newName);
+    m_iconPaths.remove(node);
+    m_resolvingIcons.remove(node);
+
+    // 保持名称排序
+    int parentNode = m_nodes[node].parent;
+    int row = m_nodes[node].row;
+    QVector<int> &siblings = m_nodes[parentNode].children;
+    siblings.remove(row);
+    int newRow = insertPosition(parentNode, newName);
+    siblings.insert(row, node);
+
+    QModelIndex parentIndex = indexFor(parentNode);
+    if(newRow != row && beginMoveRows(parentIndex, row, row, parentIndex, newRow > row ? newRow + 1 : newRow))
+    {
+        siblings.remove(row);
+        siblings.insert(newRow, node);
+        renumber(parentNode, qMin(row, newRow));
+        endMoveRows();
+    }
+
+    QModelIndex index = indexFor(node);
+    emit dataChanged(index, index);
+    return true;
+}
+
+// ======== 快照 ========
+// 格式：魔数、版本、根路径、根节点ID、名称池，然后按先序写出每个已读取目录的子项：
+// 子项数，每项为节点ID、名称ID、标志（项目/已读取/展开/图标已知）、图标路径
+QByteArray RepoTreeModel::saveSnapshot(const std::function<bool(const QModelIndex&)> &isExpanded) const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << m_rootPath << qint32(m_nodes[0].nodeId) << m_names;
+    writeSnapshotNode(stream, 0, isExpanded);
+    return data;
+}
+
+bool RepoTreeModel::restoreSnapshot(const QByteArray &data, const QString &rootPath, int rootNodeId,
+                                    QModelIndexList *expanded)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if(magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) return false;
+
+    QString savedRootPath;
+    qint32 savedRootNodeId = 0;
+    QVector<QString> names;
+    stream >> savedRootPath >> savedRootNodeId >> names;
+    if(stream.status() != QDataStream::Ok) return false;
+    // 根目录或根节点变化时快照失效
+    if(savedRootPath != QDir(rootPath).absolutePath() || savedRootNodeId != rootNodeId) return false;
+
+    // 先解析到临时结构，数据完整后再替换模型
+    QVector<TreeNode> nodes(1);
+    nodes[0].used = true;
+    nodes[0].listed = true;
+    nodes[0].nodeId = rootNodeId;
+    QHash<int, QString> iconPaths;
+    QVector<int> expandedNodes;
+    if(!readSnapshotNode(stream, 0, names, nodes, iconPaths, expandedNodes)) return false;
+
+    beginResetModel();
+    m_generation++;
+    m_rootPath = savedRootPath;
+    m_nodes = nodes;
+    m_freeNodes.clear();
+    m_iconPaths = iconPaths;
+    m_waitingIcons.clear();
+    // 重建名称池，去掉已不再使用的名称
+    m_names.clear();
+    m_nameIds.clear();
+    for(int node = 1; node < m_nodes.size(); node++)
+    {
+        m_nodes[node].nameId = internName(names[m_nodes[node].nameId]);
+    }
+    endResetModel();
+
+    if(expanded)
+    {
+        for(int node : expandedNodes) expanded->append(indexFor(node));
+    }
+    return true;
+}
+
+void RepoTreeModel::writeSnapshotNode(QDataStream &stream, int node,
+                                      const std::function<bool(const QModelIndex&)> &isExpanded) const
+{
+    // 未插入的子项也写入，恢复后直接插入
+    const TreeNode &treeNode = m_nodes[node];
+    const QVector<int> children = treeNode.children + treeNode.pending;
+    stream << quint32(children.size());
+    for(int i = 0; i < children.size(); i++)
+    {
+        int child = children[i];
+        const TreeNode &childNode = m_nodes[child];
+        auto icon = m_iconPaths.constFind(child);
+
+        quint8 flags = 0;
+        if(childNode.kind == Project) flags |= SnapshotProject;
+        if(childNode.listed) flags |= SnapshotListed;
+        if(i < treeNode.children.size() && isExpanded && isExpanded(indexFor(child))) flags |= SnapshotExpanded;
+        if(icon != m_iconPaths.constEnd()) flags |= SnapshotIconKnown;
+
+        stream << qint32(childNode.nodeId) << qint32(childNode.nameId) << flags;
+        if(flags & SnapshotIconKnown) stream << icon.value();
+        if(flags & SnapshotListed) writeSnapshotNode(stream, child, isExpanded);
+    }
+}
+
+bool RepoTreeModel::readSnapshotNode(QDataStream &stream, int node, const QVector<QString> &names,
+                                     QVector<TreeNode> &nodes, QHash<int, QString> &iconPaths,
+                                     QVector<int> &expandedNodes)
+{
+    quint32 count = 0;
+    stream >> count;
+    if(stream.status() != QDataStream::Ok || count > quint32(stream.device()->bytesAvailable())) return false;
+
+    nodes[node].children.reserve(count);
+    for(quint32 i = 0; i < count; i++)
+    {
+        qint32 nodeId = 0;
+        qint32 nameId = 0;
+        quint8 flags = 0;
+        stream >> nodeId >> nameId >> flags;
+        if(stream.status() != QDataStream::Ok || nameId < 0 || nameId >= names.size()) return false;
+
+        int child = nodes.size();
+        TreeNode childNode;
+        childNode.used = true;
+        childNode.nodeId = nodeId;
+        childNode.parent = node;
+        childNode.row = int(i);
+        childNode.nameId = nameId;
+        childNode.kind = (flags & SnapshotProject) ? Project : Folder;
+        childNode.listed = (flags & SnapshotListed) && childNode.kind == Folder;
+        nodes.append(childNode);
+        nodes[node].children.append(child);
+
+        if(flags & SnapshotIconKnown)
+        {
+            QString iconPath;
+            stream >> iconPath;
+            iconPaths.insert(child, iconPath);
+        }
+        if(flags & SnapshotExpanded) expandedNodes.append(child);
+        if(childNode.listed && !readSnapshotNode(stream, child, names, nodes, iconPaths, expandedNodes))
+        {
+            return false;
+        }
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+// ======== 后台校正 ========
+// 在后台读取所有已读取目录的磁盘内容（含项目图标路径），完成后在主线程应用差异
+void RepoTreeModel::reconcile()
+{
+    if(m_reconcileWatcher->isRunning()) return;
+
+    QVector<DiskListing> listings;
+    for(int node = 0; node < m_nodes.size(); node++)
+    {
+        const TreeNode &treeNode = m_nodes[node];
+        if(!treeNode.used || !treeNode.listed || treeNode.kind != Folder) continue;
+        DiskListing listing;
+        listing.node = node;
+        listing.path = pathOf(node);
+        listings.append(listing);
+    }
+    m_reconcileGeneration = m_generation;
+    m_reconcileWatcher->setFuture(QtConcurrent::run(&RepoTreeModel::scanDisk, listings));
+}
+
+bool RepoTreeModel::isReconciling() const
+{
+    return m_reconcileWatcher->isRunning();
+}
+
+// 工作线程：只访问磁盘，不访问模型和数据库
+QVector<RepoTreeModel::DiskListing> RepoTreeModel::scanDisk(QVector<DiskListing> listings)
+{
+    for(DiskListing &listing : listings)
+    {
+        QDir dir(listing.path);
+        listing.exists = dir.exists();
+        if(!listing.exists) continue;
+
+        const QStringList entries = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+        listing.entries.reserve(entries.size());
+        for(const QString &entryName : entries)
+        {
+            DiskEntry entry;
+            entry.name = entryName;
+            QString metaPath = listing.path + "/" + entryName + "/meta.ctk";
+            entry.isProject = QFile::exists(metaPath);
+            if(entry.isProject)
+            {
+                MetaCtk metaCtk(metaPath);
+                if(metaCtk.load() && !metaCtk.previewImagePath().isEmpty())
+                {
+                    entry.iconPath = QDir::cleanPath(metaCtk.previewImagePath());
+                }
+            }
+            listing.entries.append(entry);
+        }
+    }
+    return listings;
+}
+
+void RepoTreeModel::applyReconcile(const QVector<DiskListing> &listings)
+{
+    int changes = 0;
+    for(const DiskListing &listing : listings)
+    {
+        int node = listing.node;
+        // 扫描期间节点可能已被删除或复用；目录不存在时由父目录的差异删除
+        if(node >= m_nodes.size() || !m_nodes[node].used || !m_nodes[node].listed
+                || m_nodes[node].kind != Folder || pathOf(node) != listing.path || !listing.exists)
+        {
+            continue;
+        }
+
+        QHash<QString, int> diskEntries; // 类型前缀+名称 -> entries下标
+        for(int i = 0; i < listing.entries.size(); i++)
+        {
+            diskEntries.insert(dbKey(listing.entries[i].name, listing.entries[i].isProject), i);
+        }
+
+        // 删除磁盘上已不存在（或类型已变化）的子项，更新项目图标
+        QSet<QString> present;
+        const QVector<int> children = m_nodes[node].children + m_nodes[node].pending;
+        for(int child : children)
+        {
+            QString key = dbKey(nameOf(child), m_nodes[child].kind == Project);
+            auto it = diskEntries.constFind(key);
+            if(it == diskEntries.constEnd())
+            {
+                removeChild(node, child);
+                changes++;
+                continue;
+            }
+            present.insert(key);
+
+            const DiskEntry &entry = listing.entries[it.value()];
+            if(entry.isProject && (!m_iconPaths.contains(child) || m_iconPaths.value(child) != entry.iconPath))
+            {
+                bool changed = m_iconPaths.contains(child);
+                m_iconPaths.insert(child, entry.iconPath);
+                if(changed && isInserted(child))
+                {
+                    QModelIndex index = indexFor(child);
+                    emit dataChanged(index, index, {Qt::DecorationRole});
+                    changes++;
+                }
+            }
+        }
+
+        // 插入新出现的子项，需要时补入节点表（每个目录只查询一次数据库）
+        QHash<QString, int> dbIds;
+        bool dbIdsLoaded = false;
+        for(const DiskEntry &entry : listing.entries)
+        {
+            if(present.contains(dbKey(entry.name, entry.isProject))) continue;
+            if(!dbIdsLoaded)
+            {
+                dbIds = dbNodeIds(m_nodes[node].nodeId);
+                dbIdsLoaded = true;
+            }
+
+            Node newNode;
+            newNode.name = entry.name;
+            newNode.type = entry.isProject ? NodeType::Note : NodeType::Catalog;
+            newNode.parentId = m_nodes[node].nodeId;
+            newNode.id = ensureDbNode(dbIds, newNode.parentId, entry.name, entry.isProject,
+                                      listing.path + "/" + entry.name + "/meta.ctk");
+            int child = insertChild(node, newNode, false);
+            if(entry.isProject) m_iconPaths.insert(child, entry.iconPath);
+            changes++;
+        }
+    }
+
+    if(changes > 0) qInfo() << "Repository tree reconciled with" << changes << "changes";
+    emit reconciled(changes);
+}
+
+bool RepoTreeModel::isInserted(int node) const
+{
+    const QVector<int> &siblings = m_nodes[m_nodes[node].parent].children;
+    int row = m_nodes[node].row;
+    return row < siblings.size() && siblings[row] == node;
+}
+
+void RepoTreeModel::removeChild(int parent, int child)
+{
+    if(isInserted(child))
+    {
+        removeNode(indexFor(child));
+        return;
+    }
+    m_nodes[parent].pending.removeOne(child);
+    freeNode(child);
+}
+
+// 图标路径按节点缓存，缩略图由ThumbnailCache在后台生成，完成前显示默认图标；
+// 路径未知时交给后台读取，不在绘制时读取meta.ctk
+QIcon RepoTreeModel::projectIcon(int node) const
+{
+    auto it = m_iconPaths.constFind(node);
+    if(it == m_iconPaths.constEnd())
+    {
+        if(!m_resolvingIcons.contains(node) && !m_unresolvedIcons.contains(node))
+        {
+            // 同一轮绘制中请求的节点一起读取
+            if(m_unresolvedIcons.isEmpty())
+            {
+                QMetaObject::invokeMethod(const_cast<RepoTreeModel*>(this), "resolveIconPaths", Qt::QueuedConnection);
+            }
+            m_unresolvedIcons.insert(node);
+        }
+        return m_fileIcon;
+    }
+    if(it.value().isEmpty()) return m_fileIcon;
+
+    QPixmap pixmap = ThumbnailCache::getThumbnailCache()->thumbnail(it.value(), m_thumbnailSize);
+    if(pixmap.isNull())
+    {
+        if(ThumbnailCache::getThumbnailCache()->isPending(it.value(), m_thumbnailSize))
+        {
+            m_waitingIcons[it.value()].insert(node);
+        }
+        return m_fileIcon;
+    }
+    return QIcon(pixmap);
+}
+
+void RepoTreeModel::resolveIconPaths()
+{
+    if(m_iconWatcher->isRunning() || m_unresolvedIcons.isEmpty()) return;
+
+    QVector<IconRequest> requests;
+    requests.reserve(m_unresolvedIcons.size());
+    for(int node : qAsConst(m_unresolvedIcons))
+    {
+        if(node >= m_nodes.size() || !m_nodes[node].used || m_nodes[node].kind != Project) continue;
+        if(m_iconPaths.contains(node)) continue; // 已由后台校正提供
+        IconRequest request;
+        request.node = node;
+        request.metaPath = pathOf(node) + "/meta.ctk";
+        requests.append(request);
+        m_resolvingIcons.insert(node);
+    }
+    m_unresolvedIcons.clear();
+    if(requests.isEmpty()) return;
+
+    m_iconGeneration = m_generation;
+    m_iconWatcher->setFuture(QtConcurrent::run(&RepoTreeModel::readIconPaths, requests));
+}
+
+// 工作线程：只读取meta.ctk头部，预览图为封面图，没有则为第一张内容图片
+QVector<RepoTreeModel::IconRequest> RepoTreeModel::readIconPaths(QVector<IconRequest> requests)
+{
+    for(IconRequest &request : requests)
+    {
+        MetaCtk metaCtk(request.metaPath);
+        if(metaCtk.load() && !metaCtk.previewImagePath().isEmpty())
+        {
+            request.iconPath = QDir::cleanPath(metaCtk.previewImagePath());
+        }
+    }
+    return requests;
+}
+
+void RepoTreeModel::applyIconPaths(const QVector<IconRequest> &requests)
+{
+    for(const IconRequest &request : requests)
+    {
+        int node = request.node;
+        // 读取期间节点被删除、重命名或刷新图标时丢弃结果
+        if(!m_resolvingIcons.remove(node)) continue;
+        if(m_iconPaths.contains(node) || pathOf(node) + "/meta.ctk" != request.metaPath) continue;
+
+        m_iconPaths.insert(node, request.iconPath);
+        if(!request.iconPath.isEmpty() && isInserted(node))
+        {
+            QModelIndex index = indexFor(node);
+            emit dataChanged(index, index, {Qt::DecorationRole});
+        }
+    }
+}
+
+void RepoTreeModel::onThumbnailReady(const QString &imagePath, const QSize &size)
+{
+    if(size != m_thumbnailSize) return;
+    const QSet<int> nodes = m_waitingIcons.take(imagePath);
+    for(int node : nodes)
+    {
+        // 节点可能已被删除或复用
+        if(node >= m_nodes.size() || !m_nodes[node].used || m_iconPaths.value(node) != imagePath) continue;
+        QModelIndex index = indexFor(node);
+        emit dataChanged(index, index, {Qt::DecorationRole});
+    }
+}
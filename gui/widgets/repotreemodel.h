@@ -0,0 +1,201 @@
+#ifndef REPOTREEMODEL_H
+#define REPOTREEMODEL_H
+/*****************************************************
+*
+* @file     repotreemodel.h
+* @brief    代码库目录树模型
+*
+* @description
+*           ==== 核心功能 ====
+*           - 基于节点表（sqlite）与磁盘目录的树模型，供TreeWidget(QTreeView)显示
+*           - 懒加载：展开目录时才读取子项，子项按批插入（canFetchMore/fetchMore）
+*           - 紧凑存储：节点只保存ID、父节点下标、行号、名称ID（名称字符串池去重），路径按需拼接
+*           - 增量修改：insertNode/removeNode/重命名/refreshIcon只发出受影响行的信号，不重置整个模型
+*           - 切换主题时setIcons()只通知已插入的项重绘图标
+*           - 项目图标为缩略图（ThumbnailCache后台生成），生成前显示默认图标；
+*             图标路径由快照或后台校正提供，都没有时在后台读取meta.ctk头部，data()不读取磁盘
+*           - 快照：结构、展开状态、项目图标路径可保存为二进制快照，启动时直接恢复，
+*             随后reconcile()在后台扫描磁盘，只应用差异
+*           ==== 数据角色 ====
+*           PathRole(Qt::UserRole)      完整路径
+*           TypeRole(Qt::UserRole+1)    "FOLDER"/"PROJECT_FOLDER"
+*           NameRole(Qt::UserRole+2)    名称
+*           NodeIdRole(Qt::UserRole+3)  节点ID（sqlite）
+*           ==== 注意 ====
+*           读取目录时会将磁盘上存在但节点表中没有的目录补入节点表
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QAbstractItemModel>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QIcon>
+#include <QSet>
+#include <QVector>
+#include <functional>
+#include "sql_table_types.h"
+
+class QDataStream;
+class ProjectManager;
+class RepoTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        PathRole = Qt::UserRole,
+        TypeRole,
+        NameRole,
+        NodeIdRole
+    };
+
+    explicit RepoTreeModel(QObject *parent = nullptr);
+
+    void setRootPath(const QString& rootPath, int rootNodeId);
+    QString rootPath() const;
+    void setIcons(const QIcon& folderIcon, const QIcon& fileIcon);
+    void setThumbnailSize(const QSize& size) { m_thumbnailSize = size; }
+    void setFetchBatchSize(int size) { m_fetchBatchSize = size; }
+    int fetchBatchSize() const { return m_fetchBatchSize; }
+
+    // ======== QAbstractItemModel ========
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    // ======== 增量修改 ========
+    QModelIndex insertNode(const QModelIndex& parent, const Node& node);
+    void removeNode(const QModelIndex& index);
+    void refreshIcon(const QModelIndex& index);
+
+    // ======== 查询 ========
+    QModelIndex indexForPath(const QString& path); // 沿途按需读取子项
+    QModelIndex loadedIndexForPath(const QString& path) const; // 只查找已插入的项
+    bool isFolder(const QModelIndex& index) const;
+
+    // ======== 快照 ========
+    QByteArray saveSnapshot(const std::function<bool(const QModelIndex&)>& isExpanded) const;
+    bool restoreSnapshot(const QByteArray& data, const QString& rootPath, int rootNodeId,
+                         QModelIndexList *expanded = nullptr);
+    void reconcile(); // 后台对比磁盘，在主线程应用差异
+    bool isReconciling() const;
+
+signals:
+    void reconciled(int changes);
+
+private slots:
+    void onThumbnailReady(const QString& imagePath, const QSize& size);
+    void resolveIconPaths();
+
+private:
+    enum NodeKind : quint8 {
+        Folder,
+        Project
+    };
+
+    struct TreeNode {
+        int nodeId = 0;
+        int parent = -1;        // 父节点在m_nodes中的下标
+        int row = 0;            // 在父节点children中的位置
+        int nameId = -1;        // 名称在m_names中的下标
+        NodeKind kind = Folder;
+        bool listed = false;    // 是否已读取子项列表
+        bool used = false;
+        QVector<int> children;  // 已插入模型的子项
+        QVector<int> pending;   // 已读取、尚未插入的子项（分批插入）
+    };
+
+    // 后台扫描结果
+    struct DiskEntry {
+        QString name;
+        bool isProject = false;
+        QString iconPath;
+    };
+    struct DiskListing {
+        int node = -1;
+        QString path;
+        bool exists = false;
+        QVector<DiskEntry> entries;
+    };
+    struct IconRequest {
+        int node = -1;
+        QString metaPath;
+        QString iconPath;
+    };
+
+    enum SnapshotFlag : quint8 {
+        SnapshotProject   = 0x1,
+        SnapshotListed    = 0x2,
+        SnapshotExpanded  = 0x4,
+        SnapshotIconKnown = 0x8
+    };
+    static const quint32 SNAPSHOT_MAGIC = 0x43544B54; // "CTKT"
+    static const quint16 SNAPSHOT_VERSION = 1;
+
+    int nodeFor(const QModelIndex& index) const;
+    QModelIndex indexFor(int node) const;
+    int allocNode();
+    void freeNode(int node);
+    int internName(const QString& name);
+    QString nameOf(int node) const;
+    QString pathOf(int node) const;
+
+    void listChildren(int node);
+    QHash<QString, int> dbNodeIds(int parentNodeId) const;
+    static QString dbKey(const QString& name, bool isProject);
+    int ensureDbNode(const QHash<QString, int>& dbIds, int parentNodeId, const QString& name,
+                     bool isProject, const QString& metaPath);
+    int insertChild(int parentNode, const Node& node, bool listed);
+    void removeChild(int parent, int child);
+    bool isInserted(int node) const;
+    void fetchAll(int node);
+    int findChild(int node, const QString& name) const;
+    int findPending(int node, const QString& name) const;
+    int insertPosition(int parent, const QString& name) const;
+    void renumber(int parent, int fromRow);
+    void emitDecorationChanged(int node);
+    bool renameNode(int node, const QString& newName);
+    QIcon projectIcon(int node) const;
+    static QVector<IconRequest> readIconPaths(QVector<IconRequest> requests);
+    void applyIconPaths(const QVector<IconRequest>& requests);
+
+    void writeSnapshotNode(QDataStream& stream, int node,
+                           const std::function<bool(const QModelIndex&)>& isExpanded) const;
+    static bool readSnapshotNode(QDataStream& stream, int node, const QVector<QString>& names,
+                                 QVector<TreeNode>& nodes, QHash<int, QString>& iconPaths,
+                                 QVector<int>& expandedNodes);
+    static QVector<DiskListing> scanDisk(QVector<DiskListing> listings);
+    void applyReconcile(const QVector<DiskListing>& listings);
+
+    QVector<TreeNode> m_nodes;      // 下标0为不可见的根节点
+    QVector<int> m_freeNodes;
+    QVector<QString> m_names;       // 名称字符串池
+    QHash<QString, int> m_nameIds;
+    mutable QHash<int, QString> m_iconPaths;  // 节点 -> 项目图标路径（空为默认图标）
+    mutable QHash<QString, QSet<int>> m_waitingIcons; // 等待缩略图生成的节点
+    mutable QSet<int> m_unresolvedIcons;    // 等待后台读取图标路径的节点
+    QSet<int> m_resolvingIcons;             // 正在后台读取图标路径的节点
+
+    QString m_rootPath;
+    QIcon m_folderIcon;
+    QIcon m_fileIcon;
+    QSize m_thumbnailSize = QSize(32, 32);    // 兼顾高DPI
+    int m_fetchBatchSize = 256;
+    int m_generation = 0;            // 每次重置模型加一
+    int m_reconcileGeneration = -1;  // 开始校正时的m_generation
+    QFutureWatcher<QVector<DiskListing>> *m_reconcileWatcher;
+    int m_iconGeneration = -1;       // 开始读取图标路径时的m_generation
+    QFutureWatcher<QVector<IconRequest>> *m_iconWatcher;
+    ProjectManager *m_projectManager;
+};
+
+#endif // REPOTREEMODEL_H
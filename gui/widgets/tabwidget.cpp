@@ -3,6 +3,7 @@
 #include "notetab.h"
 #include "stylemanager.h"
 #include "fontmanager.h"
+#include "autosavemanager.h"
 
 #include <QTabBar>
 #include <QLabel>
@@ -151,20 +152,7 @@ void TabWidget::onTabCloseRequested(int index)
     }
 
     NoteTab* note = qobject_cast<NoteTab*>(widget);
-
-    // 如果是代码编辑器标签页且有未保存的更改
-    if(note && !note->isSaved())
-    {
-        QMessageBox::StandardButton reply;
-        reply = QMessageBox::question(this, tr("保存更改"),
-                                     tr("文件 '%1' 有未保存的更改。是否保存更改？")
-                                     .arg(tabText(index).remove('*')),
-                                     QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
-
-        if(reply == QMessageBox::Save) note->save();
-        else if(reply == QMessageBox::Cancel) return; // 取消关闭操作
-        // 如果选择Discard，继续关闭操作
-    }
+    if(note && !confirmClose(index)) return;
 
     if(note && !note->configPath().isEmpty())
     {
@@ -177,3 +165,39 @@ void TabWidget::onTabCloseRequested(int index)
     // 删除widget对象
     delete note;
 }
+
+// 关闭笔记标签页前保存或询问未保存的修改，返回false表示取消关闭
+bool TabWidget::confirmClose(int index)
+{
+    NoteTab* note = qobject_cast<NoteTab*>(widget(index));
+    if(!note || note->isSaved()) return true;
+
+    // 设置了关闭时直接保存（同步写入，失败时不关闭）
+    if(AutoSaveManager::getAutoSaveManager()->saveOnClose()) return note->saveNow();
+
+    QMessageBox::StandardButton reply;
+    reply = QMessageBox::question(this, tr("保存更改"),
+                                 tr("文件 '%1' 有未保存的更改。是否保存更改？")
+                                 .arg(tabText(index).remove('*')),
+                                 QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
+
+    if(reply == QMessageBox::Save) return note->saveNow(); // 保存失败时不关闭
+    if(reply == QMessageBox::Cancel) return false; // 取消关闭操作
+    note->discardChanges(); // 如果选择Discard，丢弃编辑日志后继续关闭操作
+    return true;
+}
+
+// 退出程序前处理所有笔记标签页，返回false表示取消退出
+bool TabWidget::confirmQuit()
+{
+    AutoSaveManager *autoSaveManager = AutoSaveManager::getAutoSaveManager();
+    for(int i = 0; i < count(); i++)
+    {
+        NoteTab* note = qobject_cast<NoteTab*>(widget(i));
+        if(!note) continue;
+        // 防抖中的编辑先写入日志，保存或询问期间异常退出也能恢复
+        if(autoSaveManager->autoSave()) note->flushJournal();
+        if(!confirmClose(i)) return false;
+    }
+    return true;
+}
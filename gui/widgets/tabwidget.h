@@ -29,6 +29,7 @@ public:
     void addNoteTab(const QString &path = "");
     void addTagsTab();
 
+    bool confirmQuit(); // 退出前保存或询问所有未保存的笔记，返回false表示取消退出
 
 signals:
     void openNote(const QString &fullPath);
@@ -41,6 +42,7 @@ private slots:
 private:
     // 添加首页选项卡（有且只有一个）
     void addHomeTab();
+    bool confirmClose(int index);
 
     HomeTab* m_homeTab;
 
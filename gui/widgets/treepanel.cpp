@@ -21,6 +21,11 @@ void TreePanel::setupTreeView(const QString &url)
     m_treeWidget->setupTreeView(url);
 }
 
+void TreePanel::saveSnapshot()
+{
+    m_treeWidget->saveSnapshot();
+}
+
 void TreePanel::initUI()
 {
     // 垂直布局：工具区、树视图
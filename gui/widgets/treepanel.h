@@ -28,6 +28,8 @@ public:
     explicit TreePanel(QWidget *parent = nullptr);
     // 初始化 / 刷新视图
     void setupTreeView(const QString& url);
+    // 保存树快照（退出时调用）
+    void saveSnapshot();
 
 signals:
     void projectItemClicked(const QString &);
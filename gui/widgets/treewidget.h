@@ -8,33 +8,40 @@
 * @description
 *           ==== 布局 ====
 *           ==== 核心功能 ====
+*           - QTreeView + RepoTreeModel，统一行高，只绘制可见行
+*           - 目录展开时按需读取，子项较多时随滚动分批插入
 *           ==== 使用说明 ====
+*           数据角色见RepoTreeModel::Roles
 *           Qt::UserRole是文件路径
 *           Qt::UserRole+1是文件类型
 *           Qt::UserRole+2是文件名
 *           Qt::UserRole+3是节点ID（sqlite）
+*           新建、删除、重命名只更新受影响的项（insertNode/removeNode/setData），
+*           切换主题只替换图标，"刷新视图"才重新读取整棵树
+*           退出时saveSnapshot()保存树快照（data/tree.snapshot），下次启动直接显示快照，再在后台校正
 *           ==== 注意 ====
-*           当前版本，添加分类和项目均会刷新视图（更新建议：使用new/addChild）
-*           当前版本已实现懒加载，提高大型目录树的性能
 *
 * @author   无声目
 * @date     2025/08/19
 * @history
 *****************************************************/
 
-#include <QTreeWidget>
+#include <QTreeView>
 
-#include <QMap>
-#include <QJsonObject>
+#include <QSet>
+#include "sql_table_types.h"
 
 class ProjectManager;
-class TreeWidget : public QTreeWidget
+class RepoTreeModel;
+class TreeWidget : public QTreeView
 {
     Q_OBJECT
 public:
     explicit TreeWidget(QWidget *parent = nullptr);
     // 初始化 / 刷新视图
     void setupTreeView(const QString& url);
+    // 保存树快照（退出时调用）
+    void saveSnapshot();
 
 protected:
     QSize sizeHint() const override;
@@ -45,16 +52,17 @@ signals:
 
 private slots:
     void onCustomContextMenu(const QPoint& pos);
-    void onItemChanged(QTreeWidgetItem *item, int column);
-    void onItemExpanded(QTreeWidgetItem *item);
-    void refreshItem(QTreeWidgetItem *item);
+    void onItemClicked(const QModelIndex& index);
     void onSetDemoImage();
+    // 可见区域到达已插入子项末尾时继续分批插入
+    void fetchVisible();
 
 private:
-    // 加载目录结构
-    void loadDir(const QString& path, QTreeWidgetItem* parentItem, int parentNodeId = 0);
-    // 从meta.ctk文件加载图标
-    QIcon loadIconFromMetaCtk(const QString& projectPath);
+    // 从快照恢复树，成功后在后台校正
+    bool restoreSnapshot();
+    QString snapshotPath() const;
+    // 在父节点下插入新建的项
+    void addNode(const QModelIndex& parent, const Node& node);
     // 保存当前展开状态
     void saveExpandedState();
     // 恢复展开状态
@@ -69,13 +77,10 @@ private:
     QString m_rootPath; // 存储根目录路径
 
     QSet<QString> m_expandedItems; // 保存展开状态的路径集合
-    QSet<QString> m_loadedPaths;   // 记录已加载的路径，避免重复加载
+    bool m_snapshotChecked = false;  // 是否已尝试读取快照（只在首次加载时使用）
 
+    RepoTreeModel *m_model;
     ProjectManager *m_projectManager;
-
-    bool m_isOnItemChanged = false;
-    bool m_isLoadDir = false;
-    bool m_isRefreshing = false;
 };
 
 #endif // TREEWIDGET_H
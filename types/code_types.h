@@ -20,9 +20,17 @@ struct NoteItem { // 默认纯文本
     NoteContentType type;
     QString content;
     QString language;    // 代码语言
+    bool external;       // content为外部文件（BlobStore中的大内容文件）路径，而非内容本身
     // double 缩放因子
     // 字体大小 // 可以改成整体
-    NoteItem() : type(NType::Text), content(""), language(""){}
+    NoteItem() : type(NType::Text), content(""), language(""), external(false){}
+
+    bool operator==(const NoteItem& other) const
+    {
+        return type == other.type && content == other.content && language == other.language
+                && external == other.external;
+    }
+    bool operator!=(const NoteItem& other) const { return !(*this == other); }
 };
 //Q_DECLARE_METATYPE(BriefItem)
 
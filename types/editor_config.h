@@ -41,6 +41,15 @@ struct SyntaxHighlighting {
     QColor commentColor = QColor(106, 153, 85);       // 注释颜色
     QColor numberColor = QColor(159, 104, 52);        // 数字颜色
     QColor preprocessorColor = QColor(36, 132, 144);  // 预处理器颜色
+
+    bool operator==(const SyntaxHighlighting& other) const
+    {
+        return keywordColor == other.keywordColor && classColor == other.classColor
+                && functionColor == other.functionColor && variableColor == other.variableColor
+                && stringColor == other.stringColor && commentColor == other.commentColor
+                && numberColor == other.numberColor && preprocessorColor == other.preprocessorColor;
+    }
+    bool operator!=(const SyntaxHighlighting& other) const { return !(*this == other); }
 };
 using SyntaxColor = SyntaxHighlighting;
 
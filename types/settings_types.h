@@ -64,6 +64,9 @@ struct EditorSettings {
     QString scrollSpeed;
     bool saveOnClose;
     bool autoSave;
+    QString imageFormat;    // 粘贴/拖入图片的存储格式 "png" / "webp"（无损）
+    int pngCompression;     // PNG压缩级别 0~9
+    int imageCacheSize;     // 已解码图片的内存缓存上限（MB）
 
     bool isEmpty() const
     {
@@ -100,8 +103,15 @@ struct MenuSettings {
 using MenuSet = MenuSettings;
 
 struct ExportSettings {
-    // 当前版本未实现，预留扩展
-    bool isEmpty() const {return true;}
+    QString format = "html";   // "html"（静态站点） / "archive"（单个tar归档）
+    QString outputDir;         // 导出目录
+    bool incremental = true;   // 增量导出：内容未变的笔记跳过
+    int threadCount = 0;       // 导出线程数，0为自动
+
+    bool isEmpty() const
+    {
+        return format.isEmpty() && outputDir.isEmpty();
+    }
 };
 using ExportSet = ExportSettings;
 
@@ -111,6 +121,7 @@ struct GeneralSettings {
     QVector<Shortcut> shortcuts;
     bool enableLogging;
     QString logLevel;
+    QString storageFormat = "json"; // meta.ctk存储格式：json/cbor
 
     bool isEmpty() const
     {
@@ -1,4 +1,6 @@
 #include "metactk.h"
+#include "savequeue.h"
+#include "notejournal.h"
 
 #include <QJsonArray>
 #include <QJsonObject>
@@ -7,6 +9,20 @@
 #include <QJsonDocument>
 #include <QFileInfo>
 #include <QDir>
+#include <QBuffer>
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
+
+MetaCtk::StorageFormat MetaCtk::s_defaultFormat = MetaCtk::StorageFormat::Json;
 
 MetaCtk::MetaCtk(const QString &configPath, QObject *parent)
     : QObject(parent),
@@ -15,7 +31,20 @@ MetaCtk::MetaCtk(const QString &configPath, QObject *parent)
     initDefaults();
 }
 
+// 文件未变化（修改时间、大小、inode均相同）时直接使用已读取的数据
 bool MetaCtk::load(const QString &configPath)
+{
+    if(m_loaded && (configPath.isEmpty() || configPath == m_configPath
+                    || configPath + "/meta.ctk" == m_configPath)
+            && m_fileStamp == FileStamp::of(m_configPath))
+    {
+        return true;
+    }
+    return reload(configPath);
+}
+
+// 强制重新读取
+bool MetaCtk::reload(const QString &configPath)
 {
     initDefaults();
     if(!configPath.isEmpty())
@@ -46,61 +75,44 @@ bool MetaCtk::load(const QString &configPath)
         qWarning() << "Failed to open the file" << m_configPath;
         return false;
     }
-    QByteArray data = file.readAll();
-    file.close();
-
-    // 检查文件是否为空
-    if(data.trimmed().isEmpty())
-    {
-        qInfo() << "Config file is empty, using defaults" << m_configPath;
-        return true; // 空文件视为初次加载，使用默认值
-    }
-
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if(doc.isNull() || !doc.isObject())
-    {
-        qWarning() << "The file data is not a valid JSON object" << m_configPath;
-        return false;
-    }
+    // 读取前记录文件状态，读取期间被修改时下次load()会重新读取
+    FileStamp stamp = FileStamp::of(m_configPath);
+    // 只读取头部，正文延迟到需要时读取
+    if(!readDevice(&file, true)) return false;
 
-    QJsonObject root = doc.object();
-
-    // 读取基本元数据
-    QString id = root.value("ID").toString();
-    if(!id.isEmpty()) m_id = id;
-
-    QString projectName = root.value("ProjectName").toString();
-    if(!projectName.isEmpty()) m_projectName = projectName;
-
-    QString demoImage = root.value("DemoImage").toString();
-    if(!demoImage.isEmpty()) m_demoImage = demoImage;
-
-    QString author = root.value("Author").toString();
-    if(!author.isEmpty()) m_author = author;
-
-    // 读取时间戳
-    QString createdStr = root.value("Created").toString();
-    if(!createdStr.isEmpty())
-        m_created = QDateTime::fromString(createdStr, "yyyy/MM/dd hh:mm:ss.zzz");
-
-    QString modifiedStr = root.value("Modified").toString();
-    if(!modifiedStr.isEmpty())
-        m_modified = QDateTime::fromString(modifiedStr, "yyyy/MM/dd hh:mm:ss.zzz");
+    m_fileStamp = stamp;
+    m_loaded = true;
+    return true;
+}
 
-    // 读取收藏路径
-    QJsonArray favoriteArray = root.value("Favorite").toArray();
-    for(const auto& pathVal : favoriteArray)
-    {
-        m_favoritePaths.append(pathVal.toString());
-    }
+// 记录文件当前状态（本对象的数据已写入文件后调用）
+void MetaCtk::refreshFileStamp() const
+{
+    if(m_loaded) m_fileStamp = FileStamp::of(m_configPath);
+}
 
-    // 读取笔记内容
-    if(root.contains("NoteContent") && root["NoteContent"].isObject())
-    {
-        m_codeNote = jsonToNote(root["NoteContent"].toObject());
-    }
+MetaCtk::FileStamp MetaCtk::FileStamp::of(const QString &filePath)
+{
+    FileStamp stamp;
+    QFileInfo info(filePath);
+    if(!info.exists()) return stamp;
+    stamp.modified = info.lastModified().toMSecsSinceEpoch();
+    stamp.size = info.size();
+#ifndef Q_OS_WIN
+    struct stat st;
+    if(::stat(QFile::encodeName(filePath).constData(), &st) == 0) stamp.inode = st.st_ino;
+#endif
+    return stamp;
+}
 
-    return true;
+// 从内存数据完整读取（头部和正文）
+bool MetaCtk::loadFromData(const QByteArray &data)
+{
+    initDefaults();
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    return readDevice(&buffer, false);
 }
 
 bool MetaCtk::save(const QString &configPath) const
@@ -112,29 +124,6 @@ bool MetaCtk::save(const QString &configPath) const
         return false;
     }
 
-    QJsonObject root;
-
-    // 写入基本元数据
-    root["ID"] = m_id;
-    root["ProjectName"] = m_projectName;
-    root["DemoImage"] = m_demoImage;
-    root["Author"] = m_author;
-
-    // 写入时间戳
-    root["Created"] = m_created.toString("yyyy/MM/dd hh:mm:ss.zzz");
-    root["Modified"] = currentDateTimeString();
-
-    // 写入收藏路径
-    QJsonArray favoriteArray;
-    for(const auto& path : m_favoritePaths)
-    {
-        favoriteArray.append(path);
-    }
-    root["Favorite"] = favoriteArray;
-
-    // 写入笔记内容
-    root["NoteContent"] = noteToJson(m_codeNote);
-
     // 确保目录存在
     QFileInfo fileInfo(savePath);
     QDir dir = fileInfo.dir();
@@ -144,19 +133,83 @@ bool MetaCtk::save(const QString &configPath) const
         return false;
     }
 
-    // 写入文件
-    QFile file(savePath);
-    if(!file.open(QIODevice::WriteOnly))
+    // 保存前确保正文已读取，避免覆盖为空；原子写入，中途崩溃不会损坏原文件
+    QByteArray data = serialize(m_format);
+    if(data.isEmpty()) return false;
+    // 经SaveQueue写入，与同一文件排队中的后台保存按顺序进行
+    if(!SaveQueue::getSaveQueue()->writeNow(savePath, data)) return false;
+
+    if(savePath == m_configPath) refreshFileStamp();
+    return true;
+}
+
+// 后台保存：在调用线程取快照，序列化和写入在后台完成
+bool MetaCtk::saveAsync() const
+{
+    if(m_configPath.isEmpty() || !QFileInfo(m_configPath).dir().exists())
     {
-        qWarning() << "Failed to open the file" << m_configPath;
+        qWarning() << "Save failed. The saveDir does not exist" << m_configPath;
         return false;
     }
+    if(!ensureNoteContentLoaded())
+    {
+        qWarning() << "Save refused. The note content failed to load" << m_configPath;
+        return false;
+    }
+    Snapshot data = snapshot();
+    m_saveTicket = SaveQueue::getSaveQueue()->enqueue(m_configPath, [data](){
+        return serializeSnapshot(data);
+    });
+    return true;
+}
 
-    QJsonDocument doc(root);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+// 当前数据的不可变副本（CodeNote为隐式共享，复制开销很小），调用前需确认正文已读取
+MetaCtk::Snapshot MetaCtk::snapshot(bool keepModified) const
+{
+    Snapshot data;
+    data.header = headerToJson(keepModified);
+    data.codeNote = m_codeNote;
+    data.format = m_format;
+    return data;
+}
 
-    return true;
+// 序列化为指定存储格式，正文读取失败时返回空；keepModified为true时不更新修改时间（只转换格式）
+QByteArray MetaCtk::serialize(StorageFormat format, bool keepModified) const
+{
+    if(!ensureNoteContentLoaded())
+    {
+        qWarning() << "Serialize refused. The note content failed to load" << m_configPath;
+        return QByteArray();
+    }
+    Snapshot data = snapshot(keepModified);
+    data.format = format;
+    return serializeSnapshot(data);
+}
+
+QByteArray MetaCtk::serializeSnapshot(const Snapshot &data)
+{
+    if(data.format == StorageFormat::Cbor)
+    {
+        // 自描述CBOR标签作为文件魔数，随后依次为头部和正文两个数据项
+        QByteArray bytes;
+        QCborStreamWriter writer(&bytes);
+        writer.append(QCborKnownTags::Signature);
+        QCborMap::fromJsonObject(data.header).toCbor(writer);
+
+        QCborMap body;
+        body[QLatin1String("NoteContent")] = noteToCbor(data.codeNote);
+        body.toCbor(writer);
+        return bytes;
+    }
+
+    // 头部为单行紧凑json，正文（单独成段，读取头部时无需解析）紧随其后
+    QJsonObject body;
+    body["NoteContent"] = noteToJson(data.codeNote);
+
+    QByteArray bytes = QJsonDocument(data.header).toJson(QJsonDocument::Compact);
+    bytes += '\n';
+    bytes += QJsonDocument(body).toJson(QJsonDocument::Indented);
+    return bytes;
 }
 
 bool MetaCtk::isValid() const
@@ -206,11 +259,49 @@ QStringList MetaCtk::favoritePaths() const
     return m_favoritePaths;
 }
 
+QString MetaCtk::previewImagePath() const
+{
+    return m_previewImage;
+}
+
 CodeNote MetaCtk::noteContent() const
 {
+    ensureNoteContentLoaded();
     return m_codeNote;
 }
 
+bool MetaCtk::isNoteContentLoaded() const
+{
+    return m_noteContentLoaded;
+}
+
+bool MetaCtk::noteContentLoadFailed() const
+{
+    ensureNoteContentLoaded();
+    return m_noteContentFailed;
+}
+
+// 估算内存占用（QString按UTF-16计），正文未读取时只计头部
+qint64 MetaCtk::estimatedSize() const
+{
+    qint64 bytes = sizeof(MetaCtk);
+    bytes += (m_configPath.size() + m_projectName.size() + m_id.size()
+              + m_demoImage.size() + m_previewImage.size() + m_author.size()) * 2;
+    for(const QString &path : m_favoritePaths) bytes += path.size() * 2;
+
+    if(!m_noteContentLoaded) return bytes;
+    for(auto it = m_codeNote.tags.begin(); it != m_codeNote.tags.end(); it++)
+    {
+        bytes += it.key().size() * 2;
+        for(const QString &tag : it.value()) bytes += tag.size() * 2;
+    }
+    for(const NoteItem &item : m_codeNote.note)
+    {
+        bytes += sizeof(NoteItem) + (item.content.size() + item.language.size()) * 2;
+    }
+    return bytes;
+}
+
 void MetaCtk::setConfigPath(const QString &configPath)
 {
     m_configPath = configPath;
@@ -238,12 +329,17 @@ void MetaCtk::setFavoritePaths(const QStringList &pathList)
 
 void MetaCtk::setDemoImagePath(const QString &path)
 {
-    if(m_demoImage.isEmpty()) m_demoImage = path;
+    if(m_demoImage.isEmpty())
+    {
+        m_demoImage = path;
+        m_previewImage = path;
+    }
 }
 
 void MetaCtk::modifyDemoImagePath(const QString &path)
 {
     m_demoImage = path;
+    if(!path.isEmpty()) m_previewImage = path;
 }
 
 void MetaCtk::setAuthor(const QString &author)
@@ -254,10 +350,12 @@ void MetaCtk::setAuthor(const QString &author)
 void MetaCtk::setNoteContent(const CodeNote &codeNote)
 {
     m_codeNote = codeNote;
+    m_noteContentLoaded = true;
 }
 
 void MetaCtk::addTagGroup(const QString &groupName)
 {
+    ensureNoteContentLoaded();
     if(!m_codeNote.tags.contains(groupName))
     {
         m_codeNote.tags[groupName] = QStringList();
@@ -266,11 +364,13 @@ void MetaCtk::addTagGroup(const QString &groupName)
 
 void MetaCtk::removeTagGroup(const QString &groupName)
 {
+    ensureNoteContentLoaded();
     m_codeNote.tags.remove(groupName);
 }
 
 void MetaCtk::addTagToGroup(const QString &groupName, const QString &tag)
 {
+    ensureNoteContentLoaded();
     if(!m_codeNote.tags.contains(groupName))
     {
         qWarning() << "The grounName dose not exist: " << groupName;
@@ -283,6 +383,7 @@ void MetaCtk::addTagToGroup(const QString &groupName, const QString &tag)
 
 void MetaCtk::removeTagFromGroup(const QString &groupName, const QString &tag)
 {
+    ensureNoteContentLoaded();
     if(m_codeNote.tags.contains(groupName))
     {
         m_codeNote.tags[groupName].removeAll(tag);
@@ -291,10 +392,11 @@ void MetaCtk::removeTagFromGroup(const QString &groupName, const QString &tag)
 
 void MetaCtk::setTags(const QMap<QString, QStringList> &tags)
 {
+    ensureNoteContentLoaded();
     m_codeNote.tags = tags;
 }
 
-QJsonObject MetaCtk::noteToJson(const CodeNote &note) const
+QJsonObject MetaCtk::noteToJson(const CodeNote &note)
 {
     QJsonObject obj;
 
@@ -329,6 +431,7 @@ QJsonObject MetaCtk::noteToJson(const CodeNote &note) const
         }
         itemObj["content"] = item.content;
         itemObj["language"] = item.language;
+        if(item.external) itemObj["external"] = true; // 只在外部存储时写入，兼容旧文件
         noteArray.append(itemObj);
     }
     obj["note"] = noteArray;
@@ -336,7 +439,7 @@ QJsonObject MetaCtk::noteToJson(const CodeNote &note) const
     return obj;
 }
 
-CodeNote MetaCtk::jsonToNote(const QJsonObject &json) const
+CodeNote MetaCtk::jsonToNote(const QJsonObject &json)
 {
     CodeNote note;
 
@@ -375,12 +478,425 @@ CodeNote MetaCtk::jsonToNote(const QJsonObject &json) const
 
             item.content = itemObj["content"].toString();
             item.language = itemObj["language"].toString();
+            item.external = itemObj["external"].toBool();
             note.note.append(item);
         }
     }
     return note;
 }
 
+// 读取头部元数据
+void MetaCtk::readHeader(const QJsonObject &root)
+{
+    QString id = root.value("ID").toString();
+    if(!id.isEmpty()) m_id = id;
+
+    QString projectName = root.value("ProjectName").toString();
+    if(!projectName.isEmpty()) m_projectName = projectName;
+
+    QString demoImage = root.value("DemoImage").toString();
+    if(!demoImage.isEmpty()) m_demoImage = demoImage;
+
+    QString author = root.value("Author").toString();
+    if(!author.isEmpty()) m_author = author;
+
+    m_previewImage = root.value("PreviewImage").toString();
+    if(m_previewImage.isEmpty()) m_previewImage = m_demoImage;
+
+    // 读取时间戳
+    QString createdStr = root.value("Created").toString();
+    if(!createdStr.isEmpty())
+        m_created = QDateTime::fromString(createdStr, "yyyy/MM/dd hh:mm:ss.zzz");
+
+    QString modifiedStr = root.value("Modified").toString();
+    if(!modifiedStr.isEmpty())
+        m_modified = QDateTime::fromString(modifiedStr, "yyyy/MM/dd hh:mm:ss.zzz");
+
+    // 读取收藏路径
+    QJsonArray favoriteArray = root.value("Favorite").toArray();
+    for(const auto& pathVal : favoriteArray)
+    {
+        m_favoritePaths.append(pathVal.toString());
+    }
+}
+
+// 第一次访问正文时读取（跳过头部），只有解析成功才标记为已读取；
+// 失败后不再重试，之后setNoteContent()也不能解除，直到reload()
+bool MetaCtk::ensureNoteContentLoaded() const
+{
+    if(m_noteContentFailed) return false;
+    if(m_noteContentLoaded) return true;
+
+    QFile file(m_configPath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Failed to open the file" << m_configPath;
+        m_noteContentFailed = true;
+        return false;
+    }
+
+    if(file.peek(3) == cborSignature())
+    {
+        QCborStreamReader reader(&file);
+        QCborValue::fromCbor(reader); // 跳过头部
+        QCborValue body = QCborValue::fromCbor(reader);
+        if(!body.isMap() || !body.toMap().value(QLatin1String("NoteContent")).isMap())
+        {
+            qWarning() << "The note content is not a valid CBOR map" << m_configPath;
+            m_noteContentFailed = true;
+            return false;
+        }
+        m_codeNote = cborToNote(body.toMap().value(QLatin1String("NoteContent")).toMap());
+        m_noteContentLoaded = true;
+        return true;
+    }
+
+    file.readLine();
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    if(!doc.isObject() || !doc.object()["NoteContent"].isObject())
+    {
+        qWarning() << "The note content is not a valid JSON object" << m_configPath;
+        m_noteContentFailed = true;
+        return false;
+    }
+    m_codeNote = jsonToNote(doc.object()["NoteContent"].toObject());
+    m_noteContentLoaded = true;
+    return true;
+}
+
+// 按格式读取，headerOnly为true时正文延迟读取
+bool MetaCtk::readDevice(QIODevice *device, bool headerOnly)
+{
+    // ==== CBOR格式 ====
+    if(device->peek(3) == cborSignature())
+    {
+        m_format = StorageFormat::Cbor;
+        QCborStreamReader reader(device);
+        QCborValue header = QCborValue::fromCbor(reader);
+        if(header.isTag()) header = header.taggedValue();
+        if(!header.isMap())
+        {
+            qWarning() << "The file data is not a valid CBOR map" << m_configPath;
+            return false;
+        }
+        readHeader(header.toMap().toJsonObject());
+
+        if(headerOnly)
+        {
+            m_noteContentLoaded = false;
+            return true;
+        }
+        QCborValue body = QCborValue::fromCbor(reader);
+        if(!body.isMap() || !body.toMap().value(QLatin1String("NoteContent")).isMap())
+        {
+            qWarning() << "The note content is not a valid CBOR map" << m_configPath;
+            m_noteContentFailed = true;
+            return true;
+        }
+        m_codeNote = cborToNote(body.toMap().value(QLatin1String("NoteContent")).toMap());
+        return true;
+    }
+
+    // ==== JSON格式 ====
+    m_format = StorageFormat::Json;
+    QByteArray headerLine = device->readLine();
+
+    // 检查文件是否为空
+    if(headerLine.trimmed().isEmpty() && device->atEnd())
+    {
+        qInfo() << "Config file is empty, using defaults" << m_configPath;
+        m_format = s_defaultFormat;
+        return true; // 空文件视为初次加载，使用默认值
+    }
+
+    QJsonDocument headerDoc = QJsonDocument::fromJson(headerLine);
+    if(headerDoc.isObject() && headerDoc.object().contains("Format"))
+    {
+        readHeader(headerDoc.object());
+        if(headerOnly)
+        {
+            m_noteContentLoaded = false;
+            return true;
+        }
+        QJsonDocument bodyDoc = QJsonDocument::fromJson(device->readAll());
+        if(!bodyDoc.isObject() || !bodyDoc.object()["NoteContent"].isObject())
+        {
+            qWarning() << "The note content is not a valid JSON object" << m_configPath;
+            m_noteContentFailed = true;
+            return true;
+        }
+        m_codeNote = jsonToNote(bodyDoc.object()["NoteContent"].toObject());
+        return true;
+    }
+
+    // 旧格式：整个文件为一个json对象
+    QByteArray data = headerDoc.isObject() ? headerLine : headerLine + device->readAll();
+
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if(doc.isNull() || !doc.isObject())
+    {
+        qWarning() << "The file data is not a valid JSON object" << m_configPath;
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    readHeader(root);
+
+    // 读取笔记内容
+    if(root.contains("NoteContent") && root["NoteContent"].isObject())
+    {
+        m_codeNote = jsonToNote(root["NoteContent"].toObject());
+    }
+    if(m_previewImage.isEmpty())
+    {
+        for(const NoteItem &item : m_codeNote.note)
+        {
+            if(item.type == NType::Image && !item.content.isEmpty())
+            {
+                m_previewImage = item.content;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+QJsonObject MetaCtk::headerToJson(bool keepModified) const
+{
+    QJsonObject root;
+
+    // 写入基本元数据
+    root["Format"] = 2;
+    root["ID"] = m_id;
+    root["ProjectName"] = m_projectName;
+    root["DemoImage"] = m_demoImage;
+    root["Author"] = m_author;
+
+    // 预览图：封面图，没有则为第一张内容图片（供只读头部的调用方使用）
+    QString previewImage = m_demoImage;
+    for(int i = 0; previewImage.isEmpty() && i < m_codeNote.note.size(); i++)
+    {
+        const NoteItem &item = m_codeNote.note[i];
+        if(item.type == NType::Image && !item.content.isEmpty()) previewImage = item.content;
+    }
+    root["PreviewImage"] = previewImage;
+
+    // 写入时间戳
+    root["Created"] = m_created.toString("yyyy/MM/dd hh:mm:ss.zzz");
+    root["Modified"] = keepModified ? m_modified.toString("yyyy/MM/dd hh:mm:ss.zzz") : currentDateTimeString();
+
+    // 写入收藏路径
+    QJsonArray favoriteArray;
+    for(const auto& path : m_favoritePaths)
+    {
+        favoriteArray.append(path);
+    }
+    root["Favorite"] = favoriteArray;
+
+    return root;
+}
+
+// CBOR中代码内容以原始UTF-8存储，无需转义
+QCborMap MetaCtk::noteToCbor(const CodeNote &note)
+{
+    QCborMap tagsMap;
+    for(auto it = note.tags.begin(); it != note.tags.end(); it++)
+    {
+        tagsMap[it.key()] = QCborArray::fromStringList(it.value());
+    }
+
+    QCborArray noteArray;
+    for(const auto& item : note.note)
+    {
+        QCborMap itemMap;
+        itemMap[QLatin1String("type")] = noteTypeName(item.type);
+        itemMap[QLatin1String("content")] = item.content;
+        itemMap[QLatin1String("language")] = item.language;
+        if(item.external) itemMap[QLatin1String("external")] = true;
+        noteArray.append(itemMap);
+    }
+
+    QCborMap map;
+    map[QLatin1String("tags")] = tagsMap;
+    map[QLatin1String("note")] = noteArray;
+    return map;
+}
+
+CodeNote MetaCtk::cborToNote(const QCborMap &map) const
+{
+    CodeNote note;
+
+    QCborMap tagsMap = map.value(QLatin1String("tags")).toMap();
+    for(auto it = tagsMap.begin(); it != tagsMap.end(); it++)
+    {
+        QStringList tagList;
+        for(const QCborValue &tag : it.value().toArray())
+        {
+            tagList.append(tag.toString());
+        }
+        note.tags[it.key().toString()] = tagList;
+    }
+
+    for(const QCborValue &itemVal : map.value(QLatin1String("note")).toArray())
+    {
+        QCborMap itemMap = itemVal.toMap();
+        NoteItem item;
+        item.type = noteTypeFromName(itemMap.value(QLatin1String("type")).toString());
+        item.content = itemMap.value(QLatin1String("content")).toString();
+        item.language = itemMap.value(QLatin1String("language")).toString();
+        item.external = itemMap.value(QLatin1String("external")).toBool();
+        note.note.append(item);
+    }
+    return note;
+}
+
+QString MetaCtk::noteTypeName(NoteContentType type)
+{
+    switch(type)
+    {
+    case NType::Image: return "image";
+    case NType::Markdown: return "markdown";
+    case NType::Code: return "code";
+    case NType::Text: break;
+    }
+    return "text";
+}
+
+NoteContentType MetaCtk::noteTypeFromName(const QString &name)
+{
+    if(name == "image") return NType::Image;
+    if(name == "markdown") return NType::Markdown;
+    if(name == "code") return NType::Code;
+    return NType::Text;
+}
+
+QByteArray MetaCtk::cborSignature()
+{
+    // 自描述CBOR标签55799的编码
+    return QByteArray("\xD9\xD9\xF7", 3);
+}
+
+MetaCtk::StorageFormat MetaCtk::defaultFormat()
+{
+    return s_defaultFormat;
+}
+
+void MetaCtk::setDefaultFormat(StorageFormat format)
+{
+    s_defaultFormat = format;
+}
+
+MetaCtk::StorageFormat MetaCtk::format() const
+{
+    return m_format;
+}
+
+void MetaCtk::setFormat(StorageFormat format)
+{
+    m_format = format;
+}
+
+// 将代码库中所有meta.ctk转换为指定格式，返回转换的文件数（可在工作线程调用）
+// 读取和写入都在SaveQueue的工作线程中执行，与笔记的保存按顺序进行；已有待写快照的文件跳过
+int MetaCtk::migrateRepository(const QString &rootPath, StorageFormat format)
+{
+    SaveQueue *saveQueue = SaveQueue::getSaveQueue();
+    // 先等已提交的保存落盘
+    saveQueue->flush();
+
+    QSharedPointer<QAtomicInt> converted(new QAtomicInt(0));
+    int skipped = 0;
+    QDirIterator it(rootPath, QStringList() << "meta.ctk", QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+    {
+        QString path = it.next();
+        bool queued = saveQueue->tryEnqueue(path, [path, format, converted](){
+            MetaCtk metaCtk(path);
+            if(!metaCtk.load() || metaCtk.format() == format) return QByteArray();
+            // 只转换格式，保留原修改时间；正文读取失败时为空，不写入
+            QByteArray data = metaCtk.serialize(format, true);
+            if(data.isEmpty())
+            {
+                qWarning() << "Failed to migrate" << path;
+                return QByteArray();
+            }
+            converted->ref();
+            return data;
+        });
+        if(!queued) skipped++;
+    }
+    saveQueue->flush();
+
+    if(skipped > 0) qInfo() << "Skipped" << skipped << "config files with pending saves";
+    qInfo() << "Migrated" << converted->load() << "config files in" << rootPath;
+    return converted->load();
+}
+
+// 对比两种格式的文件大小和完整解析耗时
+MetaCtk::FormatBenchmark MetaCtk::benchmarkRepository(const QString &rootPath, int iterations)
+{
+    FormatBenchmark result;
+    QElapsedTimer timer;
+
+    QDirIterator it(rootPath, QStringList() << "meta.ctk", QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+    {
+        MetaCtk source(it.next());
+        if(!source.load()) continue;
+        QByteArray jsonData = source.serialize(StorageFormat::Json);
+        QByteArray cborData = source.serialize(StorageFormat::Cbor);
+        result.files++;
+        result.jsonBytes += jsonData.size();
+        result.cborBytes += cborData.size();
+
+        MetaCtk parser;
+        timer.start();
+        for(int i = 0; i < iterations; i++) parser.loadFromData(jsonData);
+        result.jsonParseNs += timer.nsecsElapsed();
+
+        timer.start();
+        for(int i = 0; i < iterations; i++) parser.loadFromData(cborData);
+        result.cborParseNs += timer.nsecsElapsed();
+    }
+    if(iterations > 0)
+    {
+        result.jsonParseNs /= iterations;
+        result.cborParseNs /= iterations;
+    }
+    return result;
+}
+
+// 收集封面图、图片项和外部存储的代码项引用的路径；编辑日志中尚未保存的修改也计入
+bool MetaCtk::collectBlobReferences(const QString &rootPath, QSet<QString> &paths)
+{
+    QDirIterator it(rootPath, QStringList() << "meta.ctk", QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+    {
+        QString path = it.next();
+        MetaCtk metaCtk(path);
+        if(!metaCtk.load())
+        {
+            if(!QFile::exists(path)) continue; // 扫描期间被删除
+            return false;
+        }
+        paths.insert(metaCtk.demoImagePath());
+        paths.insert(metaCtk.previewImagePath());
+
+        if(metaCtk.noteContentLoadFailed()) return false;
+        CodeNote codeNote = metaCtk.noteContent();
+        QList<NoteItem> items = codeNote.note;
+        NoteJournal journal(path);
+        if(journal.exists() && journal.replay(codeNote) > 0) items += codeNote.note;
+        for(const NoteItem &item : items)
+        {
+            if(item.type == NType::Image || item.external) paths.insert(item.content);
+        }
+    }
+    return true;
+}
+
 void MetaCtk::initDefaults()
 {
     m_projectName = "untitled";
@@ -388,6 +904,7 @@ void MetaCtk::initDefaults()
     m_favoritePaths = QStringList();
 
     m_demoImage = "";
+    m_previewImage = "";
     m_created = QDateTime::currentDateTime();
     m_modified = QDateTime::currentDateTime();
     m_author = "Unknow";
@@ -395,4 +912,9 @@ void MetaCtk::initDefaults()
     // 清空笔记内容
     m_codeNote.note.clear();
     m_codeNote.tags.clear();
+    m_noteContentLoaded = true;
+    m_noteContentFailed = false;
+    m_format = s_defaultFormat;
+    m_loaded = false;
+    m_fileStamp = FileStamp();
 }
@@ -8,24 +8,38 @@
 *
 * @description
 *           ==== 核心功能 ====
-*           - 读写json格式的配置文件(meta.ctk)
+*           - 读写json或CBOR格式的配置文件(meta.ctk)，读取时按文件魔数自动识别
 *           - 管理代码笔记的元数据
 *           - 资源路径解析与验证
 *           - 自动生成唯一标识符和时间戳
 *           ==== 配置文件结构 ====
+*           第一行：头部（单行紧凑json）
+*           Format = <格式版本>
 *           ID = <唯一标识>
-*
-*
 *           DemoImage = <封面图路径>
+*           PreviewImage = <预览图路径：封面图，没有则为第一张内容图片>
 *           Created = <创建时间>
 *           Modified = <修改时间>
 *           Author = <作者>
 *           ProjectName = <项目名称>
 *           Favorite = <收藏路径列表>
+*           其余行：正文（json）
+*           NoteContent = <笔记内容>
+*           CBOR格式：自描述标签(D9 D9 F7) + 头部map + 正文map，字段同上，代码内容不转义
 *
 *           ==== 使用说明 ====
 *           1. 构造函数接收配置文件路径
 *           2. 支持读取/保存配置
+*           3. load()只读取头部，正文在第一次访问noteContent()（或修改标签、保存）时才读取；
+*              正文读取失败时noteContentLoadFailed()为true，save()/saveAsync()/serialize()拒绝写出，
+*              避免把空内容覆盖到文件中，reload()后重新尝试
+*           4. 兼容旧格式（整个文件为一个json对象），旧格式加载时一次读取全部内容
+*           5. 保存时沿用加载时识别的格式，新文件使用defaultFormat()
+*           6. migrateRepository()批量转换格式（经SaveQueue写入，保留原修改时间），
+*              benchmarkRepository()对比两种格式的大小和解析耗时
+*           7. save()经SaveQueue::writeNow()立即原子写入（临时文件+重命名）；saveAsync()取快照后交给SaveQueue在后台写入
+*           8. load()在文件未变化（修改时间、大小、inode）时不重复读取，reload()强制重新读取
+*           9. collectBlobReferences()收集代码库中已保存数据（含编辑日志）引用的存储文件，供BlobStore回收时标记
 *
 * @author   无声目
 * @date     2025/08/15
@@ -33,20 +47,73 @@
 *****************************************************/
 
 #include <QDateTime>
+#include <QJsonObject>
 #include <QObject>
 #include <QUuid>
 #include "code_types.h"
 #include <QMap>
+#include <QSet>
 
+class QIODevice;
+class QCborMap;
 class MetaCtk : public QObject
 {
     Q_OBJECT
 public:
+    // 存储格式
+    enum class StorageFormat {
+        Json,
+        Cbor
+    };
+
+    // 格式基准测试结果（解析耗时为每轮全部文件的总和）
+    struct FormatBenchmark {
+        int files = 0;
+        qint64 jsonBytes = 0;
+        qint64 cborBytes = 0;
+        qint64 jsonParseNs = 0;
+        qint64 cborParseNs = 0;
+    };
+
+    // 保存快照：头部与正文的不可变副本，可在任意线程序列化
+    struct Snapshot {
+        QJsonObject header;
+        CodeNote codeNote;
+        StorageFormat format = StorageFormat::Json;
+    };
+
+    // 文件状态，用于判断文件自上次读取后是否变化
+    struct FileStamp {
+        qint64 modified = -1;
+        qint64 size = -1;
+        quint64 inode = 0; // Windows上为0
+        bool operator==(const FileStamp& other) const
+        {
+            return modified == other.modified && size == other.size && inode == other.inode;
+        }
+        static FileStamp of(const QString& filePath);
+    };
+
     explicit MetaCtk(const QString& configPath = "", QObject *parent = nullptr);
 
     // ======== 文件操作接口 ========
     bool load(const QString& configPath = "");
+    bool reload(const QString& configPath = "");
+    void refreshFileStamp() const;
+    quint64 saveTicket() const { return m_saveTicket; } // 最近一次saveAsync()的SaveQueue提交编号
     bool save(const QString& configPath = "") const;
+    bool saveAsync() const;
+    bool loadFromData(const QByteArray& data);
+    QByteArray serialize(StorageFormat format, bool keepModified = false) const;
+
+    // ======== 存储格式接口 ========
+    StorageFormat format() const;
+    void setFormat(StorageFormat format);
+    static StorageFormat defaultFormat();
+    static void setDefaultFormat(StorageFormat format);
+    static int migrateRepository(const QString& rootPath, StorageFormat format);
+    static FormatBenchmark benchmarkRepository(const QString& rootPath, int iterations = 5);
+    static bool collectBlobReferences(const QString& rootPath, QSet<QString>& paths);
 
     // ======== 配置验证接口 ========
     bool isValid() const;
@@ -60,7 +127,11 @@ public:
     QDateTime modifed() const;
     QString author() const;
     QStringList favoritePaths() const;
+    QString previewImagePath() const;
     CodeNote noteContent() const;
+    bool isNoteContentLoaded() const;
+    bool noteContentLoadFailed() const;
+    qint64 estimatedSize() const;
 
     // ======== 数据设置接口 ========
     void setConfigPath(const QString& configPath);
@@ -80,8 +151,8 @@ public:
     void setTags(const QMap<QString, QStringList>& tags);
 
     // ======== 处理json文件 ========
-    QJsonObject noteToJson(const CodeNote& note) const;
-    CodeNote jsonToNote(const QJsonObject& json) const;
+    static QJsonObject noteToJson(const CodeNote& note);
+    static CodeNote jsonToNote(const QJsonObject& json);
     bool saveNoteToFile(const CodeNote& note, const QString& filePath) const;
 
     // 静态工具方法
@@ -98,6 +169,17 @@ signals:
 
 private:
     void initDefaults(); // 初始化默认值
+    void readHeader(const QJsonObject& root);
+    bool ensureNoteContentLoaded() const; // 延迟读取正文，失败返回false
+    bool readDevice(QIODevice *device, bool headerOnly);
+    Snapshot snapshot(bool keepModified = false) const;
+    static QByteArray serializeSnapshot(const Snapshot& data);
+    QJsonObject headerToJson(bool keepModified) const;
+    static QCborMap noteToCbor(const CodeNote& note);
+    CodeNote cborToNote(const QCborMap& map) const;
+    static QString noteTypeName(NoteContentType type);
+    static NoteContentType noteTypeFromName(const QString& name);
+    static QByteArray cborSignature();
 
     QString m_configPath;// 配置文件路径
 
@@ -109,8 +191,17 @@ private:
     QDateTime m_created;
     QDateTime m_modified;
     QString m_author;
+    QString m_previewImage;
+
+    mutable CodeNote m_codeNote;
+    mutable bool m_noteContentLoaded = true;
+    mutable bool m_noteContentFailed = false; // 正文读取失败，m_codeNote不可信
+    StorageFormat m_format = StorageFormat::Json;
+    bool m_loaded = false;          // 是否已从文件读取
+    mutable FileStamp m_fileStamp;  // 读取时的文件状态
+    mutable quint64 m_saveTicket = 0; // 区分同一文件的不同写入者和本对象先后的保存
 
-    CodeNote m_codeNote;
+    static StorageFormat s_defaultFormat;
 };
 
 #endif // METACTK_H
@@ -0,0 +1,214 @@
+#include "notejournal.h"
+#include "savequeue.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+const QByteArray JOURNAL_MAGIC("CTKJ");
+const int FRAME_HEADER_SIZE = 6; // 长度(4) + 校验(2)
+
+// 记录类型
+enum JournalOp {
+    SetItem = 0,
+    Resize  = 1,
+    SetTags = 2
+};
+
+QByteArray frameRecord(const QCborMap &record)
+{
+    QByteArray payload = record.toCborValue().toCbor();
+    QByteArray frame;
+    QDataStream stream(&frame, QIODevice::WriteOnly);
+    stream << quint32(payload.size()) << qChecksum(payload.constData(), payload.size());
+    frame += payload;
+    return frame;
+}
+}
+
+NoteJournal::NoteJournal(const QString &configPath)
+{
+    setConfigPath(configPath);
+}
+
+void NoteJournal::setConfigPath(const QString &configPath)
+{
+    m_journalPath = configPath.isEmpty() ? "" : journalPathFor(configPath);
+}
+
+QString NoteJournal::journalPath() const
+{
+    return m_journalPath;
+}
+
+QString NoteJournal::journalPathFor(const QString &configPath)
+{
+    return configPath + ".journal";
+}
+
+// 按项比较，只记录变化的项
+int NoteJournal::appendChanges(const CodeNote &base, const CodeNote &current)
+{
+    if(m_journalPath.isEmpty()) return -1;
+
+    QByteArray frames;
+    int count = 0;
+    if(base.note.size() != current.note.size())
+    {
+        QCborMap record;
+        record[QLatin1String("op")] = Resize;
+        record[QLatin1String("n")] = current.note.size();
+        frames += frameRecord(record);
+        count++;
+    }
+    for(int i = 0; i < current.note.size(); i++)
+    {
+        const NoteItem &item = current.note[i];
+        if(i < base.note.size() && base.note[i] == item) continue;
+
+        QCborMap record;
+        record[QLatin1String("op")] = SetItem;
+        record[QLatin1String("i")] = i;
+        record[QLatin1String("t")] = static_cast<int>(item.type);
+        record[QLatin1String("c")] = item.content;
+        record[QLatin1String("l")] = item.language;
+        if(item.external) record[QLatin1String("x")] = true;
+        frames += frameRecord(record);
+        count++;
+    }
+    if(base.tags != current.tags)
+    {
+        QCborMap tags;
+        for(auto it = current.tags.begin(); it != current.tags.end(); it++)
+        {
+            tags[it.key()] = QCborArray::fromStringList(it.value());
+        }
+        QCborMap record;
+        record[QLatin1String("op")] = SetTags;
+        record[QLatin1String("g")] = tags;
+        frames += frameRecord(record);
+        count++;
+    }
+    if(count == 0) return 0;
+
+    QFile file(m_journalPath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qWarning() << "Failed to open the file" << m_journalPath;
+        return -1;
+    }
+    if(file.size() == 0) frames.prepend(JOURNAL_MAGIC);
+    // 一次写入整批记录，崩溃时最多留下一条不完整的记录
+    if(file.write(frames) != frames.size())
+    {
+        qWarning() << "Failed to append the journal" << m_journalPath << file.errorString();
+        return -1;
+    }
+    if(SaveQueue::getSaveQueue()->syncPolicy() != SaveQueue::NoSync) SaveQueue::syncToDisk(file);
+    return count;
+}
+
+int NoteJournal::replay(CodeNote &note) const
+{
+    QFile file(m_journalPath);
+    if(!file.open(QIODevice::ReadOnly)) return 0;
+    QByteArray data = file.readAll();
+    if(!data.startsWith(JOURNAL_MAGIC))
+    {
+        qWarning() << "The journal is damaged" << m_journalPath;
+        return 0;
+    }
+
+    int applied = 0;
+    int pos = JOURNAL_MAGIC.size();
+    while(pos + FRAME_HEADER_SIZE <= data.size())
+    {
+        QDataStream stream(data.mid(pos, FRAME_HEADER_SIZE));
+        quint32 length;
+        quint16 checksum;
+        stream >> length >> checksum;
+        if(pos + FRAME_HEADER_SIZE + qint64(length) > data.size()) break;
+
+        QByteArray payload = data.mid(pos + FRAME_HEADER_SIZE, length);
+        if(qChecksum(payload.constData(), payload.size()) != checksum) break;
+        pos += FRAME_HEADER_SIZE + length;
+
+        QCborMap record = QCborValue::fromCbor(payload).toMap();
+        switch(record.value(QLatin1String("op")).toInteger(-1))
+        {
+        case SetItem:
+        {
+            int index = record.value(QLatin1String("i")).toInteger(-1);
+            if(index < 0) continue;
+            while(note.note.size() <= index) note.note.append(NoteItem());
+            NoteItem &item = note.note[index];
+            item.type = static_cast<NoteContentType>(record.value(QLatin1String("t")).toInteger());
+            item.content = record.value(QLatin1String("c")).toString();
+            item.language = record.value(QLatin1String("l")).toString();
+            item.external = record.value(QLatin1String("x")).toBool();
+            break;
+        }
+        case Resize:
+        {
+            int count = record.value(QLatin1String("n")).toInteger(-1);
+            if(count < 0) continue;
+            while(note.note.size() > count) note.note.removeLast();
+            while(note.note.size() < count) note.note.append(NoteItem());
+            break;
+        }
+        case SetTags:
+        {
+            note.tags.clear();
+            QCborMap tags = record.value(QLatin1String("g")).toMap();
+            for(auto it = tags.begin(); it != tags.end(); it++)
+            {
+                QStringList tagList;
+                for(const QCborValue &tag : it.value().toArray()) tagList.append(tag.toString());
+                note.tags[it.key().toString()] = tagList;
+            }
+            break;
+        }
+        default:
+            continue;
+        }
+        applied++;
+    }
+    if(pos < data.size()) qWarning() << "Discarded an incomplete journal record" << m_journalPath;
+    return applied;
+}
+
+bool NoteJournal::discardPrefix(qint64 offset)
+{
+    QFile file(m_journalPath);
+    if(!file.open(QIODevice::ReadOnly)) return !file.exists();
+    if(offset >= file.size())
+    {
+        file.close();
+        remove();
+        return true;
+    }
+    if(!file.seek(qMax<qint64>(offset, JOURNAL_MAGIC.size()))) return false;
+    QByteArray tail = JOURNAL_MAGIC + file.readAll();
+    file.close();
+    return SaveQueue::writeAtomically(m_journalPath, tail, SaveQueue::getSaveQueue()->syncPolicy());
+}
+
+bool NoteJournal::exists() const
+{
+    return !m_journalPath.isEmpty() && QFile::exists(m_journalPath);
+}
+
+qint64 NoteJournal::size() const
+{
+    return QFileInfo(m_journalPath).size();
+}
+
+void NoteJournal::remove()
+{
+    if(!m_journalPath.isEmpty()) QFile::remove(m_journalPath);
+}
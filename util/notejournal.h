@@ -0,0 +1,54 @@
+#ifndef NOTEJOURNAL_H
+#define NOTEJOURNAL_H
+/*****************************************************
+*
+* @file     notejournal.h
+* @brief    笔记编辑日志（预写日志）
+*
+* @description
+*           ==== 核心功能 ====
+*           - 将笔记的变化以单项记录追加到meta.ctk旁的日志文件，代价与修改量成正比
+*           - 程序异常退出后，将日志重放到meta.ctk中的内容上即可恢复未保存的编辑
+*           - 保存（压缩）完成后丢弃已写入meta.ctk的日志前缀
+*           ==== 文件结构 ====
+*           <meta.ctk路径>.journal
+*           文件头：CTKJ（4字节）
+*           记录：  长度(quint32) + 校验(quint16) + CBOR载荷
+*           载荷：  SetItem{序号, 类型, 内容, 语言} / Resize{项数} / SetTags{标签}
+*           ==== 注意 ====
+*           1. 记录均为“设为某值”，重放不依赖中间状态，可以重复重放
+*           2. 重放在遇到截断或校验失败的记录时停止（崩溃时写了一半的记录）
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QString>
+#include "code_types.h"
+
+class NoteJournal
+{
+public:
+    explicit NoteJournal(const QString& configPath = "");
+
+    void setConfigPath(const QString& configPath);
+    QString journalPath() const;
+    static QString journalPathFor(const QString& configPath);
+
+    // 追加从base到current的变化，返回写入的记录数（-1表示写入失败）
+    int appendChanges(const CodeNote& base, const CodeNote& current);
+    // 将日志中的记录应用到note，返回应用的记录数
+    int replay(CodeNote& note) const;
+    // 丢弃offset之前的记录（这些记录已保存到meta.ctk）
+    bool discardPrefix(qint64 offset);
+
+    bool exists() const;
+    qint64 size() const;
+    void remove();
+
+private:
+    QString m_journalPath;
+};
+
+#endif // NOTEJOURNAL_H
@@ -0,0 +1,204 @@
+#include "savequeue.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+SaveQueue::SaveQueue(QObject *parent) : QObject(parent)
+{
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(-1);
+}
+
+SaveQueue::~SaveQueue()
+{
+    flush();
+}
+
+// 提交保存任务，已有未开始的任务时只替换快照
+quint64 SaveQueue::enqueue(const QString &filePath, Serializer serializer)
+{
+    bool scheduled;
+    quint64 ticket;
+    {
+        QMutexLocker locker(&m_mutex);
+        scheduled = m_pending.contains(filePath);
+        ticket = m_nextTicket++;
+        m_pending[filePath] = PendingSave{std::move(serializer), ticket};
+    }
+    if(scheduled) return ticket;
+
+    m_pool.start([=](){
+        drain(filePath);
+    });
+    return ticket;
+}
+
+// 已有排队中的快照时放弃提交并返回0
+quint64 SaveQueue::tryEnqueue(const QString &filePath, Serializer serializer)
+{
+    quint64 ticket;
+    {
+        QMutexLocker locker(&m_mutex);
+        if(m_pending.contains(filePath)) return 0;
+        ticket = m_nextTicket++;
+        m_pending[filePath] = PendingSave{std::move(serializer), ticket};
+    }
+    m_pool.start([=](){
+        drain(filePath);
+    });
+    return ticket;
+}
+
+bool SaveQueue::isPending(const QString &filePath) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.contains(filePath) || m_writing.contains(filePath);
+}
+
+// 等待所有保存完成（阻塞调用线程）
+void SaveQueue::flush()
+{
+    m_pool.waitForDone();
+}
+
+SaveQueue::SyncPolicy SaveQueue::syncPolicy() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_syncPolicy;
+}
+
+void SaveQueue::setSyncPolicy(SyncPolicy policy)
+{
+    QMutexLocker locker(&m_mutex);
+    m_syncPolicy = policy;
+}
+
+// 工作线程：取出最新快照并写入；同一文件正在同步写入时等待其完成
+void SaveQueue::drain(const QString &filePath)
+{
+    PendingSave pending;
+    SyncPolicy policy;
+    {
+        QMutexLocker locker(&m_mutex);
+        pending = m_pending.take(filePath);
+        if(!pending.serializer) return;
+        while(m_writing.contains(filePath)) m_writeDone.wait(&m_mutex);
+        m_writing.insert(filePath);
+        policy = m_syncPolicy;
+    }
+
+    writeSnapshot(filePath, pending, policy);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_writing.remove(filePath);
+    }
+    m_writeDone.wakeAll();
+}
+
+// 调用线程中立即写入：先写入该文件排队中的旧快照，写入期间队列中更新的快照等待
+bool SaveQueue::writeNow(const QString &filePath, const QByteArray &data)
+{
+    PendingSave older;
+    SyncPolicy policy;
+    {
+        QMutexLocker locker(&m_mutex);
+        while(m_writing.contains(filePath)) m_writeDone.wait(&m_mutex);
+        older = m_pending.take(filePath);
+        m_writing.insert(filePath);
+        policy = m_syncPolicy;
+    }
+
+    if(older.serializer) writeSnapshot(filePath, older, policy);
+    bool success = writeAtomically(filePath, data, policy);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_writing.remove(filePath);
+    }
+    m_writeDone.wakeAll();
+    return success;
+}
+
+// 序列化并写入一个排队的快照，完成后发出saveFinished()
+// 无需写入时文件保持不变，同样发出成功信号，等待该文件的调用方不会一直等下去
+bool SaveQueue::writeSnapshot(const QString &filePath, const PendingSave &pending, SyncPolicy policy)
+{
+    QByteArray data = pending.serializer();
+    bool success = data.isNull() || writeAtomically(filePath, data, policy);
+    emit saveFinished(filePath, success, pending.ticket);
+    return success;
+}
+
+// 将已打开文件的内容同步到磁盘
+void SaveQueue::syncToDisk(QFile &file)
+{
+    file.flush();
+#ifdef Q_OS_WIN
+    FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#else
+    ::fsync(file.handle());
+#endif
+}
+
+// 写入临时文件并落盘后重命名覆盖，任意时刻目标文件都是完整的旧版本或新版本
+// 临时文件名唯一，多个线程同时保存同一文件时不会写入同一个临时文件
+bool SaveQueue::writeAtomically(const QString &filePath, const QByteArray &data, SyncPolicy policy)
+{
+    QTemporaryFile file(filePath + ".XXXXXX.saving");
+    if(!file.open())
+    {
+        qWarning() << "Failed to create a temporary file for" << filePath << file.errorString();
+        return false;
+    }
+    QString tempPath = file.fileName();
+    // 临时文件默认只有所有者可读写，沿用原文件的权限
+    if(QFile::exists(filePath)) file.setPermissions(QFile::permissions(filePath));
+    if(file.write(data) != data.size() || !file.flush())
+    {
+        qWarning() << "Failed to write the file" << tempPath << file.errorString();
+        return false;
+    }
+
+    if(policy != NoSync) syncToDisk(file);
+    file.close();
+
+#ifdef Q_OS_WIN
+    bool renamed = MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(tempPath).utf16()),
+                               reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(filePath).utf16()),
+                               MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    bool renamed = ::rename(QFile::encodeName(tempPath).constData(),
+                            QFile::encodeName(filePath).constData()) == 0;
+#endif
+    if(!renamed)
+    {
+        qWarning() << "Failed to replace the file" << filePath;
+        return false; // 临时文件由QTemporaryFile删除
+    }
+    file.setAutoRemove(false);
+
+#ifndef Q_OS_WIN
+    // 同步目录项，保证重命名在断电后仍然有效
+    if(policy == SyncFileAndDir)
+    {
+        int dirFd = ::open(QFile::encodeName(QFileInfo(filePath).absolutePath()).constData(), O_RDONLY);
+        if(dirFd >= 0)
+        {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+    }
+#endif
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef SAVEQUEUE_H
+#define SAVEQUEUE_H
+/*****************************************************
+*
+* @file     savequeue.h
+* @brief    后台保存队列（单例）
+*
+* @description
+*           ==== 核心功能 ====
+*           - 在后台线程序列化并写入配置文件快照，不阻塞界面
+*           - 原子写入：先写同目录下名称唯一的临时文件，落盘后重命名覆盖目标文件，崩溃时旧文件保持完整
+*           - 同一文件的多次保存合并，只写入最新的快照
+*           - 所有写入在同一个工作线程中按顺序执行；同步写入（writeNow）与队列按同一文件互斥，
+*             先写入该文件排队中的旧快照，并等待正在进行的写入，旧快照不会覆盖同步写入的结果
+*           ==== 落盘策略 ====
+*           NoSync         只依赖操作系统缓存，最快，断电可能丢失最近的保存
+*           SyncFile       重命名前同步临时文件（默认）
+*           SyncFileAndDir 额外同步所在目录，保证重命名本身也已落盘（仅Unix有效）
+*           ==== 使用说明 ====
+*           1. enqueue()提交快照，完成后发出saveFinished()；isPending()包含排队中和正在写入的文件
+*              每次提交返回全局唯一、递增的编号，合并后随saveFinished()传回最新快照的编号，
+*              提交者据此判断结果是否属于自己的最新保存（同一文件可能有多个写入者）
+*              tryEnqueue()在该文件已有排队中的快照时不提交（返回0），用于不应覆盖用户保存的批量改写（如格式迁移）
+*              序列化函数返回空（isNull）表示无需写入，文件不变，仍发出saveFinished(path, true)
+*           2. 需要立即得到结果的保存（如MetaCtk::save()）调用writeNow()，不要直接调用writeAtomically()
+*           3. 程序退出前调用flush()等待所有写入完成
+*
+* @author   无声目
+* @date     2025/10/19
+* @history
+*****************************************************/
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QObject>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <functional>
+
+class QFile;
+class SaveQueue : public QObject
+{
+    Q_OBJECT
+public:
+    enum SyncPolicy {
+        NoSync,
+        SyncFile,
+        SyncFileAndDir
+    };
+
+    // 在工作线程中执行的序列化函数，返回要写入的数据
+    using Serializer = std::function<QByteArray()>;
+
+    // 单例模式
+    static SaveQueue *getSaveQueue()
+    {
+        static SaveQueue s;
+        return &s;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    SaveQueue(const SaveQueue&) = delete;
+    SaveQueue& operator=(const SaveQueue&) = delete;
+
+    quint64 enqueue(const QString& filePath, Serializer serializer);
+    quint64 tryEnqueue(const QString& filePath, Serializer serializer);
+    bool writeNow(const QString& filePath, const QByteArray& data);
+    bool isPending(const QString& filePath) const;
+    void flush();
+
+    SyncPolicy syncPolicy() const;
+    void setSyncPolicy(SyncPolicy policy);
+
+    static bool writeAtomically(const QString& filePath, const QByteArray& data, SyncPolicy policy);
+    static void syncToDisk(QFile& file);
+
+signals:
+    void saveFinished(const QString& filePath, bool success, quint64 ticket);
+
+private:
+    explicit SaveQueue(QObject *parent = nullptr);
+    ~SaveQueue();
+
+    // 待写快照及其提交编号
+    struct PendingSave {
+        Serializer serializer;
+        quint64 ticket = 0;
+    };
+
+    void drain(const QString& filePath);
+    bool writeSnapshot(const QString& filePath, const PendingSave& pending, SyncPolicy policy);
+
+    QHash<QString, PendingSave> m_pending; // 文件路径 -> 最新的待写快照
+    QSet<QString> m_writing;              // 正在写入的文件（队列或同步写入）
+    QThreadPool m_pool;                   // 单线程，保证写入顺序
+    mutable QMutex m_mutex;
+    QWaitCondition m_writeDone;           // 某个文件写入结束
+    quint64 m_nextTicket = 1;
+    SyncPolicy m_syncPolicy = SyncFile;
+};
+
+#endif // SAVEQUEUE_H